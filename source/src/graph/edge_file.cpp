@@ -0,0 +1,358 @@
+#include "edge_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/contract.hpp>
+
+namespace algo
+{
+
+namespace
+{
+constexpr char magic[8] = {'A', 'L', 'G', 'O', 'E', 'D', 'G', '1'};
+
+[[noreturn]] void io_error(const std::string& what, const std::string& path)
+{
+    throw std::runtime_error(what + ": " + path);
+}
+
+std::uint64_t read_u64(std::istream& in, const std::string& path)
+{
+    std::uint64_t v;
+    if (not in.read(reinterpret_cast<char*>(&v), sizeof(v)))
+        io_error("truncated edge file", path);
+    return v;
+}
+
+void write_u64(std::ostream& out, std::uint64_t v)
+{
+    out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+}
+
+edge_file::edge_file(std::string path)
+    : file_path{std::move(path)}
+{
+    std::ifstream in(file_path, std::ios::binary);
+    if (not in)
+        io_error("cannot open edge file", file_path);
+
+    char header_magic[sizeof(magic)];
+    if (not in.read(header_magic, sizeof(header_magic)) or std::memcmp(header_magic, magic, sizeof(magic)) != 0)
+        io_error("not an edge file", file_path);
+
+    nv = read_u64(in, file_path);
+    ne = read_u64(in, file_path);
+    index_size = static_cast<std::size_t>(read_u64(in, file_path));
+    if (index_size != 4 and index_size != 8)
+        io_error("bad index width in edge file", file_path);
+
+    // Sizes are checked against the file before anything is allocated.
+    constexpr auto max_u64 = std::numeric_limits<std::uint64_t>::max();
+    in.seekg(0, std::ios::end);
+    const auto file_size = static_cast<std::uint64_t>(in.tellg());
+    if (ne > (max_u64 - header_bytes) / index_size or nv >= max_u64 / sizeof(std::uint64_t) - 1
+        or file_size - header_bytes < ne * index_size
+        or file_size - header_bytes - ne * index_size != (nv + 1) * sizeof(std::uint64_t))
+        io_error("edge file size does not match its header", file_path);
+
+    in.seekg(static_cast<std::streamoff>(header_bytes + ne * index_size));
+    offsets.resize(nv + 1);
+    if (not in.read(reinterpret_cast<char*>(offsets.data()),
+                    static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t))))
+        io_error("truncated edge file", file_path);
+
+    if (offsets.front() != 0 or offsets.back() != ne
+        or not std::is_sorted(offsets.begin(), offsets.end()))
+        io_error("bad offsets in edge file", file_path);
+}
+
+edge_file_writer::edge_file_writer(const std::string& path, edge_file::vert_t num_vert)
+    : out(path, std::ios::binary | std::ios::trunc),
+      file_path{path},
+      nv{num_vert},
+      index_size{num_vert <= std::numeric_limits<std::uint32_t>::max() ? 4u : 8u}
+{
+    if (not out)
+        io_error("cannot create edge file", file_path);
+
+    offsets.reserve(nv + 1);
+    offsets.push_back(0);
+    buffer.reserve(default_io_block_bytes);
+
+    // Placeholder, rewritten by close() once num_edges is known.
+    const std::vector<char> header(edge_file::header_bytes, 0);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+}
+
+edge_file_writer::~edge_file_writer()
+{
+    if (closed)
+        return;
+
+    out.close();
+    std::remove(file_path.c_str());
+}
+
+void edge_file_writer::write_target(std::uint64_t t)
+{
+    if (t >= nv)
+        io_error("neighbour out of range in edge file", file_path);
+
+    if (buffer.size() + index_size > buffer.capacity())
+        flush();
+
+    char bytes[sizeof(std::uint64_t)];
+    if (index_size == 4)
+    {
+        const auto narrow = static_cast<std::uint32_t>(t);
+        std::memcpy(bytes, &narrow, sizeof(narrow));
+    }
+    else
+    {
+        std::memcpy(bytes, &t, sizeof(t));
+    }
+    buffer.insert(buffer.end(), bytes, bytes + index_size);
+    ++edges_written;
+}
+
+void edge_file_writer::end_vertex()
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(offsets.size() <= nv); });
+
+    offsets.push_back(edges_written);
+}
+
+void edge_file_writer::flush()
+{
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    if (not out)
+        io_error("cannot write edge file", file_path);
+}
+
+void edge_file_writer::close()
+{
+    if (closed)
+        return;
+
+    // Targets written for a vertex that was not ended still belong to it;
+    // the vertices after it get empty lists.
+    while (offsets.size() < nv + 1)
+        offsets.push_back(edges_written);
+    flush();
+
+    out.write(reinterpret_cast<const char*>(offsets.data()),
+              static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+
+    out.seekp(0);
+    out.write(magic, sizeof(magic));
+    write_u64(out, nv);
+    write_u64(out, offsets.back());
+    write_u64(out, index_size);
+
+    out.close();
+    if (not out)
+        io_error("cannot write edge file", file_path);
+    closed = true;
+}
+
+namespace
+{
+// Serves the neighbour lists of sorted frontiers out of one buffer. Each read
+// starts at the first list not yet buffered and extends over the following
+// frontier lists while it stays within block_bytes and at most half of it
+// lies between the lists, so a level reads at most twice the size of its
+// lists. A single list longer than block_bytes is read whole.
+class block_reader
+{
+public:
+    block_reader(const edge_file& f, std::size_t block_bytes, io_stats& io_init)
+        : file{f}, in(f.path(), std::ios::binary), block{block_bytes}, io{io_init}
+    {
+        if (not in)
+            io_error("cannot open edge file", f.path());
+    }
+
+    // Calls visit(u, v) for every neighbour v of every u in frontier, which
+    // must be sorted.
+    template <typename F>
+    void for_each_neighbour(const std::vector<edge_file::vert_t>& frontier, F visit)
+    {
+        for (std::size_t i = 0; i < frontier.size(); ++i)
+        {
+            const auto u = frontier[i];
+            const auto begin = file.neighbours_begin(u);
+            const auto end = file.neighbours_end(u);
+            if (begin == end)
+                continue;
+
+            if (begin < buffer_begin or end > buffer_begin + buffer.size())
+                load(frontier, i);
+
+            const char* p = buffer.data() + (begin - buffer_begin);
+            const auto width = file.index_bytes();
+            for (auto pos = begin; pos < end; pos += width, p += width)
+            {
+                edge_file::vert_t t;
+                if (width == 4)
+                {
+                    std::uint32_t narrow;
+                    std::memcpy(&narrow, p, sizeof(narrow));
+                    t = narrow;
+                }
+                else
+                {
+                    std::memcpy(&t, p, sizeof(t));
+                }
+
+                if (t >= file.num_vert())
+                    io_error("neighbour out of range in edge file", file.path());
+                visit(u, t);
+            }
+        }
+    }
+
+private:
+    void load(const std::vector<edge_file::vert_t>& frontier, std::size_t first)
+    {
+        const auto begin = file.neighbours_begin(frontier[first]);
+        auto end = file.neighbours_end(frontier[first]);
+        auto needed = end - begin;
+
+        for (auto i = first + 1; i < frontier.size(); ++i)
+        {
+            const auto list_begin = file.neighbours_begin(frontier[i]);
+            const auto list_end = file.neighbours_end(frontier[i]);
+            if (list_begin == list_end)
+                continue;
+            if (list_end - begin > block or list_end - begin > 2 * (needed + list_end - list_begin))
+                break;
+
+            needed += list_end - list_begin;
+            end = list_end;
+        }
+
+        const auto bytes = end - begin;
+        buffer.resize(static_cast<std::size_t>(bytes));
+        in.seekg(static_cast<std::streamoff>(begin));
+        if (not in.read(buffer.data(), static_cast<std::streamsize>(bytes)))
+            io_error("truncated edge file", file.path());
+
+        buffer_begin = begin;
+        io.bytes_read += bytes;
+        ++io.read_calls;
+    }
+
+    const edge_file& file;
+    std::ifstream in;
+    std::size_t block;
+    io_stats& io;
+    std::vector<char> buffer;
+    std::uint64_t buffer_begin = 0;
+};
+
+// Runs a level-synchronous BFS from source over vertices for which
+// unvisited(v) holds, calling mark(v, parent) as each one is reached.
+template <typename Unvisited, typename Mark>
+void level_bfs(block_reader& reader, io_stats& io, edge_file::vert_t source, Unvisited unvisited, Mark mark)
+{
+    std::vector<edge_file::vert_t> frontier{source};
+    std::vector<edge_file::vert_t> next;
+    mark(source, source);
+
+    while (not frontier.empty())
+    {
+        ++io.levels;
+        reader.for_each_neighbour(frontier, [&](edge_file::vert_t u, edge_file::vert_t v)
+                                  {
+                                      if (unvisited(v))
+                                      {
+                                          mark(v, u);
+                                          next.push_back(v);
+                                      }
+                                  });
+
+        std::sort(next.begin(), next.end());
+        frontier.swap(next);
+        next.clear();
+    }
+}
+}
+
+io_stats semi_external_bfs_for_each_visited(const edge_file& file, edge_file::vert_t source,
+                                            std::function<void(edge_file::vert_t, edge_file::vert_t)> f,
+                                            std::size_t block_bytes)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(source < file.num_vert());
+                           BOOST_CONTRACT_ASSERT(block_bytes > 0); });
+
+    io_stats io;
+    block_reader reader(file, block_bytes, io);
+    std::vector<bool> visited(file.num_vert(), false);
+
+    level_bfs(reader, io, source,
+              [&](edge_file::vert_t v) { return not visited[v]; },
+              [&](edge_file::vert_t v, edge_file::vert_t parent)
+              {
+                  visited[v] = true;
+                  if (f) f(v, parent);
+              });
+
+    return io;
+}
+
+semi_external_distances semi_external_distances_from(const edge_file& file, edge_file::vert_t source,
+                                                     std::size_t block_bytes)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(source < file.num_vert());
+                           BOOST_CONTRACT_ASSERT(block_bytes > 0); });
+
+    semi_external_distances result;
+    result.distances.assign(file.num_vert(), graph::max_dist);
+    auto& dists = result.distances;
+
+    block_reader reader(file, block_bytes, result.io);
+    level_bfs(reader, result.io, source,
+              [&](edge_file::vert_t v) { return dists[v] == graph::max_dist; },
+              [&](edge_file::vert_t v, edge_file::vert_t parent)
+              {
+                  dists[v] = v == parent ? 0 : dists[parent] + 1;
+              });
+
+    return result;
+}
+
+semi_external_components semi_external_connected_components(const edge_file& file, std::size_t block_bytes)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(block_bytes > 0); });
+
+    constexpr auto unlabelled = std::numeric_limits<edge_file::vert_t>::max();
+
+    semi_external_components result;
+    result.component.assign(file.num_vert(), unlabelled);
+    auto& component = result.component;
+
+    block_reader reader(file, block_bytes, result.io);
+    for (edge_file::vert_t s = 0; s < file.num_vert(); ++s)
+    {
+        if (component[s] != unlabelled) continue;
+
+        const auto id = result.num_components++;
+        level_bfs(reader, result.io, s,
+                  [&](edge_file::vert_t v) { return component[v] == unlabelled; },
+                  [&](edge_file::vert_t v, edge_file::vert_t) { component[v] = id; });
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace algo
+{
+
+// On-disk adjacency for semi-external traversals: vertex state stays in
+// memory while neighbour lists are streamed from the file in large blocks.
+//
+// Layout, all integers in native byte order:
+//   header   "ALGOEDG1", num_vert, num_edges, index_bytes (uint64 each)
+//   targets  num_edges neighbour ids of index_bytes (4 or 8) each,
+//            grouped by source vertex in ascending order
+//   offsets  num_vert + 1 uint64; the neighbours of v are targets
+//            [offsets[v], offsets[v + 1])
+// Offsets come last so the file can be written in one streaming pass.
+class edge_file
+{
+public:
+    using vert_t = std::uint64_t;
+
+    constexpr static std::size_t header_bytes = 32;
+
+    // Reads the header and the offsets; throws std::runtime_error on I/O
+    // errors and on files whose size or offsets do not match the header.
+    // Neighbour ids are checked as the traversals read them.
+    explicit edge_file(std::string path);
+
+    const std::string& path() const { return file_path; }
+    vert_t num_vert() const { return nv; }
+    std::uint64_t num_edges() const { return ne; }
+    std::size_t index_bytes() const { return index_size; }
+
+    // Position in the file of the first neighbour of v, and one past its last.
+    std::uint64_t neighbours_begin(vert_t v) const { return header_bytes + offsets[v] * index_size; }
+    std::uint64_t neighbours_end(vert_t v) const { return header_bytes + offsets[v + 1] * index_size; }
+
+private:
+    std::string file_path;
+    vert_t nv;
+    std::uint64_t ne;
+    std::size_t index_size;
+    std::vector<std::uint64_t> offsets;
+};
+
+// Writes an edge_file one vertex at a time, in order 0, 1, ..., so graphs
+// that do not fit in memory can be converted as they are produced. Only the
+// offsets (one per vertex) are kept in memory. The file becomes a valid
+// edge_file only in close(); a writer destroyed before close() succeeds, e.g.
+// because the producer threw, removes it.
+class edge_file_writer
+{
+public:
+    edge_file_writer(const std::string& path, edge_file::vert_t num_vert);
+    ~edge_file_writer();
+
+    edge_file_writer(const edge_file_writer&) = delete;
+    edge_file_writer& operator=(const edge_file_writer&) = delete;
+
+    // Appends the out-neighbours of the next vertex; throws
+    // std::runtime_error on a neighbour id not below num_vert.
+    template <typename Range>
+    void add_vertex(const Range& neighbours)
+    {
+        for (auto t : neighbours)
+            write_target(static_cast<std::uint64_t>(t));
+        end_vertex();
+    }
+
+    // Gives the remaining vertices empty lists and writes offsets and header.
+    void close();
+
+private:
+    void write_target(std::uint64_t t);
+    void end_vertex();
+    void flush();
+
+    std::ofstream out;
+    std::string file_path;
+    edge_file::vert_t nv;
+    std::size_t index_size;
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t edges_written = 0;
+    std::vector<char> buffer;
+    bool closed = false;
+};
+
+template <typename VertInd>
+void write_edge_file(const basic_graph<VertInd>& g, const std::string& path)
+{
+    edge_file_writer writer(path, g.num_vert());
+    for (VertInd v = 0; v < g.num_vert(); ++v)
+        writer.add_vertex(g.neighbours_of(v));
+    writer.close();
+}
+
+struct io_stats
+{
+    std::uint64_t bytes_read = 0;
+    std::uint64_t read_calls = 0;
+    // BFS levels expanded, each reading the lists of one frontier.
+    std::uint64_t levels = 0;
+};
+
+// Default limit on a read covering several neighbour lists.
+constexpr std::size_t default_io_block_bytes = 4 << 20;
+
+struct semi_external_distances
+{
+    std::vector<graph::dist_t> distances;
+    io_stats io;
+};
+
+struct semi_external_components
+{
+    // component[v] is the id of v's component, numbered from 0 in order of
+    // the smallest vertex.
+    std::vector<edge_file::vert_t> component;
+    edge_file::vert_t num_components = 0;
+    io_stats io;
+};
+
+// Level-synchronous BFS: each level sorts its frontier and reads the
+// neighbour lists in file order, coalescing nearby lists into reads of up to
+// block_bytes. A level reads at most twice the bytes of its frontier's lists.
+// f(v, parent) is called for every visited vertex, with parent == v for source.
+io_stats semi_external_bfs_for_each_visited(const edge_file& file, edge_file::vert_t source,
+                                            std::function<void(edge_file::vert_t, edge_file::vert_t)> f,
+                                            std::size_t block_bytes = default_io_block_bytes);
+
+// Same result as distances_from on the graph the file was written from.
+semi_external_distances semi_external_distances_from(const edge_file& file, edge_file::vert_t source,
+                                                     std::size_t block_bytes = default_io_block_bytes);
+
+// Connected components of a file storing both directions of every edge, as
+// written from an undirected graph.
+semi_external_components semi_external_connected_components(const edge_file& file,
+                                                             std::size_t block_bytes = default_io_block_bytes);
+
+}
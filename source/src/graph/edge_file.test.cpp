@@ -0,0 +1,184 @@
+#include "edge_file.hpp"
+#include "test_graphs.hpp"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+
+namespace
+{
+// Removes the file when the test is done with it.
+struct temp_path
+{
+    explicit temp_path(const std::string& name)
+        : path{"edge_file.test." + name + ".bin"}
+    {}
+
+    ~temp_path()
+    {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+// Overwrites the 8 bytes at offset in the file at path with value.
+void patch_u64(const std::string& path, std::streamoff offset, std::uint64_t value)
+{
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(offset);
+    f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+}
+
+TEST_CASE("semi-external distances match in-memory distances")
+{
+    const algo::graph::vert_ind_t n = 3000;
+    algo::graph g(n);
+    // The last ten vertices stay unreachable.
+    for (const auto& e : algo::test::random_edges(n - 10, 2 * n, 11))
+        g.add_undirected_edge(e.source, e.target);
+
+    temp_path file("distances");
+    algo::write_edge_file(g, file.path);
+    const algo::edge_file ef(file.path);
+
+    REQUIRE(ef.num_vert() == n);
+    REQUIRE(ef.num_edges() == 4 * n);
+    REQUIRE(ef.index_bytes() == 4u);
+
+    // A small block forces many reads; the result must not depend on it.
+    for (std::size_t block_bytes : {std::size_t{64}, algo::default_io_block_bytes})
+    {
+        const auto result = algo::semi_external_distances_from(ef, 0, block_bytes);
+        REQUIRE(result.distances == algo::distances_from(g, 0));
+        REQUIRE(result.io.read_calls > 0);
+        REQUIRE(result.io.bytes_read >= result.io.read_calls);
+        REQUIRE(result.io.levels > 1);
+    }
+
+    const auto whole_file = algo::semi_external_distances_from(ef, 0);
+    REQUIRE(whole_file.io.bytes_read <= whole_file.io.levels * ef.num_edges() * ef.index_bytes());
+
+    std::size_t visited = 0;
+    algo::semi_external_bfs_for_each_visited(ef, 0, [&](auto, auto) { ++visited; });
+    std::size_t expected_visited = 0;
+    algo::bfs_for_each_visited(g, 0, [&](algo::graph::vert_ind_t) { ++expected_visited; });
+    REQUIRE(visited == expected_visited);
+}
+
+TEST_CASE("sparse frontiers read only their own lists")
+{
+    // A path whose vertices are scattered over the file, so every level
+    // needs two short lists far apart.
+    const algo::graph::vert_ind_t n = 20000;
+    std::vector<algo::graph::vert_ind_t> label(n);
+    std::iota(label.begin(), label.end(), 0);
+    std::mt19937 rng(3);
+    std::shuffle(label.begin(), label.end(), rng);
+
+    algo::graph g(n);
+    for (algo::graph::vert_ind_t i = 1; i < n; ++i)
+        g.add_undirected_edge(label[i - 1], label[i]);
+
+    temp_path file("sparse");
+    algo::write_edge_file(g, file.path);
+    const algo::edge_file ef(file.path);
+
+    const auto result = algo::semi_external_distances_from(ef, label[n / 2]);
+    REQUIRE(result.distances == algo::distances_from(g, label[n / 2]));
+    REQUIRE(result.io.bytes_read <= 2 * ef.num_edges() * ef.index_bytes());
+}
+
+TEST_CASE("semi-external connected components")
+{
+    algo::graph g(7);
+    g.add_undirected_edge(0, 1);
+    g.add_undirected_edge(1, 2);
+    g.add_undirected_edge(3, 4);
+    g.add_undirected_edge(6, 4);
+
+    temp_path file("components");
+    algo::write_edge_file(g, file.path);
+    const auto result = algo::semi_external_connected_components(algo::edge_file(file.path));
+
+    REQUIRE(result.num_components == 3u);
+    REQUIRE(result.component == std::vector<algo::edge_file::vert_t>{0, 0, 0, 1, 1, 2, 1});
+}
+
+TEST_CASE("edge file writer pads vertices that were not written")
+{
+    temp_path file("padding");
+    {
+        algo::edge_file_writer writer(file.path, 4);
+        writer.add_vertex(std::vector<int>{1, 2});
+        writer.add_vertex(std::vector<int>{});
+        writer.close();
+    }
+
+    const algo::edge_file ef(file.path);
+    REQUIRE(ef.num_edges() == 2u);
+    REQUIRE(algo::semi_external_distances_from(ef, 0).distances
+            == std::vector<algo::graph::dist_t>{0, 1, 1, algo::graph::max_dist});
+    REQUIRE_THROWS_AS(algo::edge_file("edge_file.test.missing.bin"), std::runtime_error);
+}
+
+TEST_CASE("edge file writer leaves no file unless closed")
+{
+    temp_path file("unclosed");
+    {
+        algo::edge_file_writer writer(file.path, 4);
+        writer.add_vertex(std::vector<int>{1, 2});
+        REQUIRE_THROWS_AS(writer.add_vertex(std::vector<int>{3, 4}), std::runtime_error);
+    }
+
+    REQUIRE(not std::ifstream(file.path));
+    REQUIRE_THROWS_AS(algo::edge_file(file.path), std::runtime_error);
+}
+
+TEST_CASE("corrupt edge files are rejected")
+{
+    algo::graph g(3);
+    g.add_undirected_edge(0, 1);
+    g.add_undirected_edge(1, 2);
+
+    temp_path file("corrupt");
+    // Four targets of 4 bytes follow the header, then four offsets.
+    const std::streamoff targets = algo::edge_file::header_bytes;
+    const std::streamoff offsets = targets + 4 * 4;
+
+    SECTION("edge count does not match the file size")
+    {
+        algo::write_edge_file(g, file.path);
+        patch_u64(file.path, 16, 1000);
+        REQUIRE_THROWS_AS(algo::edge_file(file.path), std::runtime_error);
+    }
+
+    SECTION("offsets decrease")
+    {
+        algo::write_edge_file(g, file.path);
+        patch_u64(file.path, offsets + 2 * 8, 0);
+        REQUIRE_THROWS_AS(algo::edge_file(file.path), std::runtime_error);
+    }
+
+    SECTION("last offset is not the edge count")
+    {
+        algo::write_edge_file(g, file.path);
+        patch_u64(file.path, offsets + 3 * 8, 3);
+        REQUIRE_THROWS_AS(algo::edge_file(file.path), std::runtime_error);
+    }
+
+    SECTION("neighbour id out of range")
+    {
+        algo::write_edge_file(g, file.path);
+        // Targets 0 and 1 become 0xffffffff.
+        patch_u64(file.path, targets, ~std::uint64_t{0});
+        const algo::edge_file ef(file.path);
+        REQUIRE_THROWS_AS(algo::semi_external_distances_from(ef, 0), std::runtime_error);
+        REQUIRE_THROWS_AS(algo::semi_external_connected_components(ef), std::runtime_error);
+    }
+}
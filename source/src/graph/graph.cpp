@@ -1,7 +1,14 @@
 #include "graph.hpp"
+#include "parallel.hpp"
+#include "versioned_graph.hpp"
 #include <istream>
 #include <ostream>
-#include <queue>
+#include <map>
+#include <array>
+#include <atomic>
+#include <utility>
+#include <numeric>
+#include <thread>
 
 #include <boost/contract.hpp>
 
@@ -48,17 +55,40 @@ std::vector<graph> undirected_graph_from_text_input(std::istream& in)
 
 namespace
 {
-void print_undirected_adj_list(const graph::adj_list_t& l, std::ostream& os)
+template <typename AdjList>
+void print_undirected_adj_list(const AdjList& l, std::ostream& os)
 {
     for (const auto& v : l)
         os << "-> " << v;
 }
 }
 
-void print_undirected_graph(const graph& g, std::ostream& os)
+namespace
+{
+// Calls f(target, weight) for every edge leaving v; edges of unweighted
+// graphs weigh 1.
+template <typename Graph, typename F>
+void for_each_weighted_edge(Graph const& g, typename Graph::vert_ind_t v, F f)
+{
+    const auto& neighbours = g.neighbours_of(v);
+    if (not g.is_weighted())
+    {
+        for (auto t : neighbours)
+            f(t, typename Graph::weight_t{1});
+        return;
+    }
+
+    const auto& weights = g.weights_of(v);
+    for (std::size_t i = 0; i < neighbours.size(); ++i)
+        f(neighbours[i], weights[i]);
+}
+}
+
+template <typename VertInd>
+void print_undirected_graph(const basic_graph<VertInd>& g, std::ostream& os)
 {
     const auto num_vert = g.num_vert();
-    for (graph::vert_ind_t i = 0; i < num_vert; ++i)
+    for (VertInd i = 0; i < num_vert; ++i)
     {
         os << i;
         print_undirected_adj_list(g.neighbours_of(i), os);
@@ -66,40 +96,62 @@ void print_undirected_graph(const graph& g, std::ostream& os)
     }
 }
 
-void bfs_for_each_visited(const graph& g, graph::vert_ind_t initial, std::function<void(graph::vert_ind_t)> f)
+namespace
 {
-    boost::contract::check c = boost::contract::function()
-        .precondition([&]{ BOOST_CONTRACT_ASSERT(initial < g.num_vert()); });
-
-    if (g.num_vert() == 0u)
-        return;
-
-    auto visited = std::make_unique<bool[]>(g.num_vert());
-    for (bool* b = visited.get(); b != visited.get() + g.num_vert(); ++b) *b = false;
-    std::queue<graph::vert_ind_t> to_visit;
+// Scratch for the overloads that take none, so each thread allocates it once.
+template <typename VertInd>
+basic_traversal_scratch<VertInd>& thread_scratch()
+{
+    thread_local basic_traversal_scratch<VertInd> scratch;
+    return scratch;
+}
 
-    auto visit = [&](auto v) {
-        to_visit.push(v);
-        visited[v] = true;
-        if (f) f(v);
-    };
+// Runs f on the thread's scratch, moved out for the duration of the call. The
+// traversals taking a callback use this, so a callback that starts another
+// traversal on the same thread gets a scratch of its own instead of
+// overwriting the marks of the one in progress.
+template <typename VertInd, typename F>
+void with_thread_scratch(F f)
+{
+    auto scratch = std::move(thread_scratch<VertInd>());
+    f(scratch);
+    thread_scratch<VertInd>() = std::move(scratch);
+}
+}
 
-    visit(initial);
+template <typename Graph>
+void bfs_for_each_visited(const Graph& g, typename Graph::vert_ind_t initial,
+                          std::function<void(typename Graph::vert_ind_t)> f)
+{
+    with_thread_scratch<typename Graph::vert_ind_t>([&](auto& scratch)
+                                                    { bfs_for_each_visited(g, initial, std::move(f), scratch); });
+}
 
-    while (not to_visit.empty())
-    {
-        auto current = to_visit.front();
-        to_visit.pop();
+template <typename Graph>
+void bfs_for_each_visited(const Graph& g, typename Graph::vert_ind_t initial,
+                          std::function<void(typename Graph::vert_ind_t)> f,
+                          basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
+{
+    bfs_for_each_visited(g, initial,
+                         std::function<void(typename Graph::vert_ind_t, typename Graph::vert_ind_t)>(
+                             [&f](auto v, auto) { if (f) f(v); }),
+                         scratch);
+}
 
-        for (auto v : g.neighbours_of(current))
-        {
-            if (not visited[v])
-                visit(v);
-        }
-    }
+template <typename Graph>
+void bfs_for_each_visited(const Graph& g, typename Graph::vert_ind_t initial,
+                          std::function<void(typename Graph::vert_ind_t,
+                                             typename Graph::vert_ind_t)> f)
+{
+    with_thread_scratch<typename Graph::vert_ind_t>([&](auto& scratch)
+                                                    { bfs_for_each_visited(g, initial, std::move(f), scratch); });
 }
 
-void bfs_for_each_visited(const graph& g, graph::vert_ind_t initial, std::function<void(graph::vert_ind_t, graph::vert_ind_t)> f)
+template <typename Graph>
+void bfs_for_each_visited(const Graph& g, typename Graph::vert_ind_t initial,
+                          std::function<void(typename Graph::vert_ind_t,
+                                             typename Graph::vert_ind_t)> f,
+                          basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
 {
     boost::contract::check c = boost::contract::function()
         .precondition([&]{ BOOST_CONTRACT_ASSERT(initial < g.num_vert()); });
@@ -107,26 +159,23 @@ void bfs_for_each_visited(const graph& g, graph::vert_ind_t initial, std::functi
     if (g.num_vert() == 0u)
         return;
 
-    auto visited = std::make_unique<bool[]>(g.num_vert());
-    for (bool* b = visited.get(); b != visited.get() + g.num_vert(); ++b) *b = false;
-    std::queue<graph::vert_ind_t> to_visit;
+    scratch.start(g.num_vert());
+    auto& to_visit = scratch.frontier[0];
 
     auto visit = [&](auto v, auto s) {
-                     to_visit.push(v);
-                     visited[v] = true;
+                     to_visit.push_back(v);
+                     scratch.mark(0, v);
                      if (f) f(v, s);
                  };
 
     visit(initial, initial);
 
-    while (not to_visit.empty())
+    for (std::size_t head = 0; head < to_visit.size(); ++head)
     {
-        auto current = to_visit.front();
-        to_visit.pop();
-
+        const auto current = to_visit[head];
         for (auto v : g.neighbours_of(current))
         {
-            if (not visited[v])
+            if (not scratch.seen(0, v))
                 visit(v, current);
         }
     }
@@ -134,20 +183,34 @@ void bfs_for_each_visited(const graph& g, graph::vert_ind_t initial, std::functi
 
 namespace
 {
-void dfs_helper(const graph& g, graph::vert_ind_t current, std::function<void(graph::vert_ind_t)>& f, bool visited[])
+template <typename Graph>
+void dfs_helper(const Graph& g, typename Graph::vert_ind_t current,
+                std::function<void(typename Graph::vert_ind_t)>& f,
+                basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
 {
     for (auto v : g.neighbours_of(current))
     {
-        if (visited[v]) continue;
+        if (scratch.seen(0, v)) continue;
 
-        visited[v] = true;
+        scratch.mark(0, v);
         if (f) f(v);
-        dfs_helper(g, v, f, visited);
+        dfs_helper(g, v, f, scratch);
     }
 }
 }
 
-void dfs_for_each_visited(const graph& g, graph::vert_ind_t initial, std::function<void(graph::vert_ind_t)> f)
+template <typename Graph>
+void dfs_for_each_visited(const Graph& g, typename Graph::vert_ind_t initial,
+                          std::function<void(typename Graph::vert_ind_t)> f)
+{
+    with_thread_scratch<typename Graph::vert_ind_t>([&](auto& scratch)
+                                                    { dfs_for_each_visited(g, initial, std::move(f), scratch); });
+}
+
+template <typename Graph>
+void dfs_for_each_visited(const Graph& g, typename Graph::vert_ind_t initial,
+                          std::function<void(typename Graph::vert_ind_t)> f,
+                          basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
 {
     boost::contract::check c = boost::contract::function()
         .precondition([&]{ BOOST_CONTRACT_ASSERT(initial < g.num_vert()); });
@@ -155,40 +218,77 @@ void dfs_for_each_visited(const graph& g, graph::vert_ind_t initial, std::functi
     if (g.num_vert() == 0u)
         return;
 
-    auto visited = std::make_unique<bool[]>(g.num_vert());
-    for (bool* b = visited.get(); b != visited.get() + g.num_vert(); ++b) *b = false;
-
-    visited[initial] = true;
+    scratch.start(g.num_vert());
+    scratch.mark(0, initial);
     if (f) f(initial);
-    dfs_helper(g, initial, f, visited.get());
+    dfs_helper(g, initial, f, scratch);
 }
 
-graph::vert_ind_t find_mother_vertex(const graph& g)
+namespace
 {
-    const auto nv = g.num_vert();
-    auto visited = std::make_unique<bool[]>(nv);
 
-    graph::vert_ind_t mother_node = graph::npos;
+// Marks every vertex reachable from source on side 0 of the current
+// traversal and returns how many were newly marked.
+template <typename Graph>
+std::size_t mark_reachable(const Graph& g, typename Graph::vert_ind_t source,
+                           basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
+{
+    auto& queue = scratch.frontier[0];
+    queue.clear();
 
-    for (graph::vert_ind_t i = 0; i < nv; ++i)
+    scratch.mark(0, source);
+    queue.push_back(source);
+    for (std::size_t head = 0; head < queue.size(); ++head)
     {
-        if (visited[i]) continue;
-
-        dfs_for_each_visited(g, i, [&](auto v) { visited[v] = true; });
-        mother_node = i;
+        for (auto v : g.neighbours_of(queue[head]))
+        {
+            if (scratch.seen(0, v)) continue;
+            scratch.mark(0, v);
+            queue.push_back(v);
+        }
     }
 
-    for (graph::vert_ind_t i = 0; i < nv; ++i) visited[i] = false;
+    return queue.size();
+}
+}
+
+template <typename Graph>
+typename Graph::vert_ind_t find_mother_vertex(const Graph& g)
+{
+    return find_mother_vertex(g, thread_scratch<typename Graph::vert_ind_t>());
+}
+
+template <typename Graph>
+typename Graph::vert_ind_t find_mother_vertex(const Graph& g,
+                                              basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
+{
+    using graph_t = Graph;
+    using VertInd = typename Graph::vert_ind_t;
+
+    const auto nv = g.num_vert();
+    if (nv == 0)
+        return graph_t::npos;
+
+    // The root of the last search started from an unvisited vertex is the
+    // only candidate.
+    scratch.start(nv);
+    VertInd mother_node = 0;
+    for (VertInd i = 0; i < nv; ++i)
+    {
+        if (scratch.seen(0, i)) continue;
 
-    dfs_for_each_visited(g, mother_node, [&](auto v) { visited[v] = true; });
+        mark_reachable(g, i, scratch);
+        mother_node = i;
+    }
 
-    if (std::all_of(visited.get(), visited.get() + nv, [](auto b) { return b; }))
+    scratch.start(nv);
+    if (mark_reachable(g, mother_node, scratch) == nv)
     {
         return mother_node;
     }
     else
     {
-        return graph::npos;
+        return graph_t::npos;
     }
 }
 
@@ -197,7 +297,7 @@ matrix::matrix(index_t r, index_t c, value_type v)
 {
 }
 
-matrix::matrix(std::initializer_list<std::initializer_list<int>> init)
+matrix::matrix(std::initializer_list<std::initializer_list<value_type>> init)
     : rows(init.size()), cols(init.begin()->size()), data()
 {
     boost::contract::check cc = boost::contract::function()
@@ -246,7 +346,8 @@ matrix::index_t matrix::indices_to_offset(matrix::index_t row_index, matrix::ind
 
 namespace
 {
-void dfs_transitive_closure_helper(graph const& g, graph::vert_ind_t v_from, graph::vert_ind_t v_to, matrix& cl)
+template <typename VertInd>
+void dfs_transitive_closure_helper(basic_graph<VertInd> const& g, VertInd v_from, VertInd v_to, matrix& cl)
 {
     cl[v_from][v_to] = 1;
     for (auto v : g.neighbours_of(v_to))
@@ -259,12 +360,13 @@ void dfs_transitive_closure_helper(graph const& g, graph::vert_ind_t v_from, gra
 }
 }
 
-matrix transitive_closure(graph const& g)
+template <typename VertInd>
+matrix transitive_closure(basic_graph<VertInd> const& g)
 {
     matrix cl(g.num_vert(), g.num_vert(), 0);
     const auto num_vert = g.num_vert();
 
-    for (graph::vert_ind_t i = 0; i < num_vert; ++i)
+    for (VertInd i = 0; i < num_vert; ++i)
     {
         dfs_transitive_closure_helper(g, i, i, cl);
     }
@@ -272,14 +374,277 @@ matrix transitive_closure(graph const& g)
     return cl;
 }
 
-graph k_cores(graph g, int k)
+namespace
+{
+// 0/1 matrix with rows packed into 64-bit words. The word loops below are
+// plain enough for the compiler to vectorize.
+struct bit_matrix
+{
+    using word_t = std::uint64_t;
+    constexpr static std::size_t word_bits = 64;
+
+    bit_matrix(std::size_t r, std::size_t c)
+        : rows{r}, cols{c}, words{(c + word_bits - 1) / word_bits}, bits(r * words, 0)
+    {}
+
+    explicit bit_matrix(const matrix& m)
+        : bit_matrix(m.num_rows(), m.num_cols())
+    {
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            const auto* src = m.row_data(i);
+            for (std::size_t j = 0; j < cols; ++j)
+            {
+                if (src[j] != 0) set(i, j);
+            }
+        }
+    }
+
+    word_t* row(std::size_t i) { return bits.data() + i * words; }
+    const word_t* row(std::size_t i) const { return bits.data() + i * words; }
+
+    bool test(std::size_t i, std::size_t j) const
+    {
+        return ((row(i)[j / word_bits] >> (j % word_bits)) & 1u) != 0;
+    }
+
+    void set(std::size_t i, std::size_t j)
+    {
+        row(i)[j / word_bits] |= word_t{1} << (j % word_bits);
+    }
+
+    matrix to_matrix() const
+    {
+        matrix m(rows, cols, 0);
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            auto* dst = m.row_data(i);
+            for (std::size_t j = 0; j < cols; ++j)
+                dst[j] = test(i, j) ? 1 : 0;
+        }
+        return m;
+    }
+
+    std::size_t rows;
+    std::size_t cols;
+    std::size_t words;
+    std::vector<word_t> bits;
+};
+
+bool operator==(const bit_matrix& lhs, const bit_matrix& rhs)
+{
+    return lhs.rows == rhs.rows and lhs.cols == rhs.cols and lhs.bits == rhs.bits;
+}
+
+// Calls f(j) for every set bit j in the given words.
+template <typename F>
+void for_each_set_bit(const bit_matrix::word_t* words, std::size_t first_word, std::size_t last_word, F f)
+{
+    for (auto w = first_word; w < last_word; ++w)
+    {
+        for (auto word = words[w]; word != 0; word &= word - 1)
+            f(w * bit_matrix::word_bits + static_cast<std::size_t>(__builtin_ctzll(word)));
+    }
+}
+
+// Boolean product: for every set bit (i, k) of a, row k of b is or-ed into
+// row i of the result. k is processed in blocks so that the rows of b in use
+// stay in cache while all rows of a are swept.
+bit_matrix multiply(const bit_matrix& a, const bit_matrix& b)
+{
+    constexpr std::size_t cache_block_bytes = 256 * 1024;
+
+    bit_matrix c(a.rows, b.cols);
+    const auto words = b.words;
+    const auto row_bytes = std::max<std::size_t>(1, words * sizeof(bit_matrix::word_t));
+    const auto k_block_words = std::max<std::size_t>(1, cache_block_bytes / row_bytes / bit_matrix::word_bits);
+
+    for (std::size_t kw0 = 0; kw0 < a.words; kw0 += k_block_words)
+    {
+        const auto kw1 = std::min(a.words, kw0 + k_block_words);
+        for (std::size_t i = 0; i < a.rows; ++i)
+        {
+            auto* c_row = c.row(i);
+            for_each_set_bit(a.row(i), kw0, kw1, [&](std::size_t k)
+                             {
+                                 const auto* b_row = b.row(k);
+                                 for (std::size_t w = 0; w < words; ++w)
+                                     c_row[w] |= b_row[w];
+                             });
+        }
+    }
+
+    return c;
+}
+
+template <typename VertInd>
+bit_matrix reflexive_adjacency_bits(basic_graph<VertInd> const& g)
+{
+    const auto nv = g.num_vert();
+    bit_matrix adj(nv, nv);
+    for (VertInd i = 0; i < nv; ++i)
+    {
+        adj.set(i, i);
+        for (auto v : g.neighbours_of(i))
+            adj.set(i, v);
+    }
+    return adj;
+}
+}
+
+matrix matrix::boolean_product(const matrix& rhs) const
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(cols == rhs.rows); });
+
+    return multiply(bit_matrix(*this), bit_matrix(rhs)).to_matrix();
+}
+
+matrix matrix::min_plus_product(const matrix& rhs) const
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(cols == rhs.rows); });
+
+    // A k_block x j_block tile of rhs (64 KiB) stays in cache while every row
+    // of the result is updated from it; the innermost loop is a branch-free
+    // min over contiguous entries. Clamping b to inf keeps a + b from
+    // overflowing.
+    constexpr index_t k_block = 64;
+    constexpr index_t j_block = 256;
+
+    matrix result(rows, rhs.cols, inf);
+
+    for (index_t k0 = 0; k0 < cols; k0 += k_block)
+    {
+        const auto k1 = std::min(cols, k0 + k_block);
+        for (index_t j0 = 0; j0 < rhs.cols; j0 += j_block)
+        {
+            const auto j1 = std::min(rhs.cols, j0 + j_block);
+            for (index_t i = 0; i < rows; ++i)
+            {
+                const auto* a_row = row_data(i);
+                auto* c_row = result.row_data(i);
+                for (index_t k = k0; k < k1; ++k)
+                {
+                    const auto a = a_row[k];
+                    if (a >= inf) continue;
+
+                    const auto* b_row = rhs.row_data(k);
+                    for (index_t j = j0; j < j1; ++j)
+                        c_row[j] = std::min(c_row[j], a + std::min(b_row[j], inf));
+                }
+            }
+        }
+    }
+
+    for (auto& v : result.data) v = std::min(v, inf);
+
+    return result;
+}
+
+template <typename VertInd>
+matrix adjacency_matrix(basic_graph<VertInd> const& g)
+{
+    const auto nv = g.num_vert();
+    matrix adj(nv, nv, 0);
+    for (VertInd i = 0; i < nv; ++i)
+    {
+        auto* row = adj.row_data(i);
+        for (auto v : g.neighbours_of(i))
+            row[v] = 1;
+    }
+    return adj;
+}
+
+template <typename VertInd>
+matrix dense_transitive_closure(basic_graph<VertInd> const& g)
+{
+    auto closure = reflexive_adjacency_bits(g);
+
+    while (true)
+    {
+        auto squared = multiply(closure, closure);
+        if (squared == closure) break;
+        closure = std::move(squared);
+    }
+
+    return closure.to_matrix();
+}
+
+template <typename VertInd>
+matrix all_pairs_distances(basic_graph<VertInd> const& g)
+{
+    const auto nv = g.num_vert();
+    const auto step = reflexive_adjacency_bits(g);
+
+    bit_matrix reached(nv, nv);
+    matrix dists(nv, nv, matrix::inf);
+    for (std::size_t i = 0; i < nv; ++i)
+    {
+        reached.set(i, i);
+        dists.row_data(i)[i] = 0;
+    }
+
+    for (matrix::value_type level = 1; ; ++level)
+    {
+        auto next = multiply(reached, step);
+        if (next == reached) break;
+
+        for (std::size_t i = 0; i < nv; ++i)
+        {
+            auto* fresh = next.row(i);
+            const auto* old = reached.row(i);
+            auto* dist_row = dists.row_data(i);
+            for (std::size_t w = 0; w < next.words; ++w)
+            {
+                for (auto word = fresh[w] & ~old[w]; word != 0; word &= word - 1)
+                    dist_row[w * bit_matrix::word_bits + static_cast<std::size_t>(__builtin_ctzll(word))] = level;
+            }
+        }
+
+        reached = std::move(next);
+    }
+
+    return dists;
+}
+
+template <typename VertInd>
+matrix all_pairs_weighted_distances(basic_graph<VertInd> const& g)
+{
+    const auto nv = g.num_vert();
+
+    matrix dists(nv, nv, matrix::inf);
+    for (VertInd i = 0; i < nv; ++i)
+    {
+        auto* row = dists.row_data(i);
+        row[i] = 0;
+
+        for_each_weighted_edge(g, i, [row](VertInd t, auto w)
+                               {
+                                   row[t] = std::min(row[t], static_cast<matrix::value_type>(w));
+                               });
+    }
+
+    // After s squarings entries cover paths of up to 2^s edges.
+    for (std::size_t span = 1; span < nv; span *= 2)
+    {
+        auto squared = dists.min_plus_product(dists);
+        if (squared == dists) break;
+        dists = std::move(squared);
+    }
+
+    return dists;
+}
+
+template <typename VertInd>
+basic_graph<VertInd> k_cores(basic_graph<VertInd> g, int k)
 {
     bool changed = true;
 
     while (changed)
     {
         changed = false;
-        for (graph::vert_ind_t i = 0; i < g.num_vert(); ++i)
+        for (VertInd i = 0; i < g.num_vert(); ++i)
         {
             if (g.degree_of(i) < k)
             {
@@ -292,62 +657,775 @@ graph k_cores(graph g, int k)
     return g;
 }
 
-std::vector<graph::dist_t> distances_from(graph const& g, graph::vert_ind_t v)
+template <typename Graph>
+std::vector<typename Graph::dist_t>
+distances_from(Graph const& g, typename Graph::vert_ind_t v)
 {
-    std::vector<graph::dist_t> dists(g.num_vert(), graph::max_dist);
-    dists.at(v) = 0;
+    return distances_from(g, v, thread_scratch<typename Graph::vert_ind_t>());
+}
 
-    auto vert_visitor = [&](auto current, auto source)
-                        {
-                            auto& current_distance = dists.at(current);
-                            if (current_distance == graph::max_dist)
-                                current_distance = 1 + dists.at(source);
-                        };
+template <typename Graph>
+std::vector<typename Graph::dist_t>
+distances_from(Graph const& g, typename Graph::vert_ind_t v,
+               basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
+{
+    using graph_t = Graph;
+
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(v < g.num_vert()); });
+
+    std::vector<typename graph_t::dist_t> dists(g.num_vert(), graph_t::max_dist);
 
-    bfs_for_each_visited(g, v, vert_visitor);
+    // dists doubles as the visited set, so only the queue is borrowed.
+    auto& queue = scratch.frontier[0];
+    queue.clear();
+
+    dists[v] = 0;
+    queue.push_back(v);
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+        const auto current = queue[head];
+        for (auto next : g.neighbours_of(current))
+        {
+            if (dists[next] != graph_t::max_dist) continue;
+            dists[next] = dists[current] + 1;
+            queue.push_back(next);
+        }
+    }
 
     return dists;
 }
 
-std::size_t count_verts_at_distance_from(graph const& g, graph::vert_ind_t v, graph::dist_t d)
+namespace
+{
+// Monotone priority queue for integer keys: every pushed key must be at least
+// the key most recently popped, which holds for Dijkstra with non-negative
+// weights. Entries live in buckets by the highest bit in which they differ
+// from the last popped key, so each entry moves down at most 64 times.
+template <typename VertInd>
+class radix_heap
 {
-    auto dists = distances_from(g, v);
-    return std::count(dists.begin(), dists.end(), d);
+public:
+    using key_t = std::uint64_t;
+    using entry_t = std::pair<key_t, VertInd>;
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    void push(key_t k, VertInd v)
+    {
+        buckets[bucket_of(k)].emplace_back(k, v);
+        ++size;
+    }
+
+    entry_t pop()
+    {
+        if (buckets[0].empty())
+        {
+            std::size_t i = 1;
+            while (buckets[i].empty()) ++i;
+
+            last = std::min_element(buckets[i].begin(), buckets[i].end())->first;
+            for (const auto& e : buckets[i])
+                buckets[bucket_of(e.first)].push_back(e);
+            buckets[i].clear();
+        }
+
+        auto top = buckets[0].back();
+        buckets[0].pop_back();
+        --size;
+        return top;
+    }
+
+private:
+    std::size_t bucket_of(key_t k) const
+    {
+        const key_t diff = k ^ last;
+        return diff == 0 ? 0 : static_cast<std::size_t>(64 - __builtin_clzll(diff));
+    }
+
+    std::array<std::vector<entry_t>, 65> buckets;
+    key_t last = 0;
+    std::size_t size = 0;
+};
+}
+
+template <typename Graph>
+std::vector<typename Graph::dist_t>
+weighted_distances_from(Graph const& g, typename Graph::vert_ind_t v)
+{
+    using graph_t = Graph;
+    using VertInd = typename Graph::vert_ind_t;
+    using key_t = typename radix_heap<VertInd>::key_t;
+
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(v < g.num_vert()); });
+
+    std::vector<typename graph_t::dist_t> dists(g.num_vert(), graph_t::max_dist);
+    radix_heap<VertInd> heap;
+
+    dists[v] = 0;
+    heap.push(0, v);
+
+    while (not heap.empty())
+    {
+        const auto top = heap.pop();
+        const auto current = top.second;
+        const auto current_distance = dists[current];
+        if (static_cast<key_t>(current_distance) != top.first)
+            continue;
+
+        for_each_weighted_edge(g, current, [&](VertInd target, auto w)
+                               {
+                                   const auto candidate = current_distance + w;
+                                   auto& target_distance = dists[target];
+                                   if (candidate < target_distance)
+                                   {
+                                       target_distance = candidate;
+                                       heap.push(static_cast<key_t>(candidate), target);
+                                   }
+                               });
+    }
+
+    return dists;
 }
 
 namespace
 {
-void paths_dfs_helper(graph const& g, std::vector<graph::path>& out,
-                      graph::path current_path, graph::vert_ind_t target)
+template <typename VertInd>
+typename basic_graph<VertInd>::weight_t mean_edge_weight(basic_graph<VertInd> const& g)
+{
+    using weight_t = typename basic_graph<VertInd>::weight_t;
+    using dist_t = typename basic_graph<VertInd>::dist_t;
+
+    if (not g.is_weighted())
+        return 1;
+
+    dist_t total = 0;
+    dist_t count = 0;
+    for (VertInd i = 0; i < g.num_vert(); ++i)
+    {
+        const auto& ws = g.weights_of(i);
+        total = std::accumulate(ws.begin(), ws.end(), total);
+        count += static_cast<dist_t>(ws.size());
+    }
+    return count == 0 ? 1 : static_cast<weight_t>(std::max<dist_t>(1, total / count));
+}
+}
+
+template <typename VertInd>
+std::vector<typename basic_graph<VertInd>::dist_t>
+delta_stepping_distances_from(basic_graph<VertInd> const& g, typename basic_graph<VertInd>::vert_ind_t v,
+                              typename basic_graph<VertInd>::weight_t delta,
+                              unsigned num_threads)
 {
-    if (current_path.last() == target)
+    using graph_t = basic_graph<VertInd>;
+    using dist_t = typename graph_t::dist_t;
+    using weight_t = typename graph_t::weight_t;
+
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(v < g.num_vert());
+                           BOOST_CONTRACT_ASSERT(delta >= 0); });
+
+    const auto nv = g.num_vert();
+    num_threads = detail::effective_thread_count(num_threads);
+    if (delta == 0) delta = mean_edge_weight(g);
+
+    std::vector<std::atomic<dist_t>> dists(nv);
+    for (auto& d : dists) d.store(graph_t::max_dist, std::memory_order_relaxed);
+
+    // Only non-empty buckets are stored, keyed by distance / delta, so the
+    // search jumps straight to the next one however large the weights are
+    // compared to delta.
+    std::map<std::size_t, std::vector<VertInd>> buckets;
+    auto bucket_insert = [&](VertInd u, dist_t d)
+                         {
+                             buckets[static_cast<std::size_t>(d / delta)].push_back(u);
+                         };
+
+    // The threads are started once and reused by every light and heavy phase.
+    // A phase relaxes at most nv sources, so on graphs too small for any phase
+    // to run in parallel no helper threads are started.
+    detail::thread_team team(nv >= detail::min_parallel_count ? num_threads : 1u);
+
+    // Relaxes the edges of sources selected by the weight predicate; every
+    // thread records the vertices it improved, which are bucketed afterwards.
+    std::vector<std::vector<VertInd>> improved(team.size());
+    auto relax = [&](const std::vector<VertInd>& sources, auto take_edge)
+                 {
+                     team.for_chunks(sources.size(),
+                                         [&](std::size_t begin, std::size_t end, unsigned t)
+                                         {
+                                             for (auto i = begin; i < end; ++i)
+                                             {
+                                                 const auto u = sources[i];
+                                                 const auto du = dists[u].load(std::memory_order_relaxed);
+                                                 for_each_weighted_edge(g, u, [&](VertInd head, weight_t w)
+                                                 {
+                                                     if (not take_edge(w)) return;
+
+                                                     const auto candidate = du + w;
+                                                     auto& target = dists[head];
+                                                     auto seen = target.load(std::memory_order_relaxed);
+                                                     while (candidate < seen
+                                                            and not target.compare_exchange_weak(seen, candidate,
+                                                                                                 std::memory_order_relaxed))
+                                                     {}
+                                                     if (candidate < seen)
+                                                         improved[t].push_back(head);
+                                                 });
+                                             }
+                                         });
+
+                     for (auto& list : improved)
+                     {
+                         for (auto u : list)
+                             bucket_insert(u, dists[u].load(std::memory_order_relaxed));
+                         list.clear();
+                     }
+                 };
+
+    auto is_light = [delta](weight_t w) { return w <= delta; };
+    auto is_heavy = [delta](weight_t w) { return w > delta; };
+
+    // Buckets keep stale and duplicate entries; they are dropped on extraction
+    // by checking the vertex still belongs to the bucket and was not already
+    // taken in the same round.
+    std::vector<std::size_t> taken_in_round(nv, std::numeric_limits<std::size_t>::max());
+    std::vector<std::size_t> settled_in_bucket(nv, std::numeric_limits<std::size_t>::max());
+    std::size_t round = 0;
+
+    dists[v].store(0, std::memory_order_relaxed);
+    bucket_insert(v, 0);
+
+    while (not buckets.empty())
     {
-        out.push_back(std::move(current_path));
-        return;
+        const auto i = buckets.begin()->first;
+        std::vector<VertInd> settled;
+
+        // Light edges can refill bucket i, heavy edges only later buckets.
+        for (auto it = buckets.begin(); it != buckets.end() and it->first == i; it = buckets.begin())
+        {
+            std::vector<VertInd> frontier;
+            frontier.swap(it->second);
+            buckets.erase(it);
+
+            auto stale = [&](VertInd u)
+                         {
+                             const auto du = dists[u].load(std::memory_order_relaxed);
+                             if (static_cast<std::size_t>(du / delta) != i or taken_in_round[u] == round)
+                                 return true;
+                             taken_in_round[u] = round;
+                             return false;
+                         };
+            frontier.erase(std::remove_if(frontier.begin(), frontier.end(), stale), frontier.end());
+            ++round;
+
+            for (auto u : frontier)
+            {
+                if (settled_in_bucket[u] != i)
+                {
+                    settled_in_bucket[u] = i;
+                    settled.push_back(u);
+                }
+            }
+
+            relax(frontier, is_light);
+        }
+
+        relax(settled, is_heavy);
+    }
+
+    std::vector<dist_t> result(nv);
+    std::transform(dists.begin(), dists.end(), result.begin(),
+                   [](const auto& d) { return d.load(std::memory_order_relaxed); });
+    return result;
+}
+
+template <typename Graph>
+std::size_t count_verts_at_distance_from(Graph const& g,
+                                         typename Graph::vert_ind_t v,
+                                         typename Graph::dist_t d)
+{
+    return count_verts_at_distance_from(g, v, d, thread_scratch<typename Graph::vert_ind_t>());
+}
+
+template <typename Graph>
+std::size_t count_verts_at_distance_from(Graph const& g,
+                                         typename Graph::vert_ind_t v,
+                                         typename Graph::dist_t d,
+                                         basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
+{
+    using graph_t = Graph;
+
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(v < g.num_vert()); });
+
+    if (d < 0)
+        return 0;
+
+    scratch.start(g.num_vert());
+    if (d == graph_t::max_dist)
+        return g.num_vert() - mark_reachable(g, v, scratch);
+
+    // Level by level, stopping once the frontier is at distance d.
+    auto& frontier = scratch.frontier[0];
+    auto& next = scratch.next;
+
+    scratch.mark(0, v);
+    frontier.push_back(v);
+    for (typename graph_t::dist_t level = 0; level < d and not frontier.empty(); ++level)
+    {
+        next.clear();
+        for (auto current : frontier)
+        {
+            for (auto w : g.neighbours_of(current))
+            {
+                if (scratch.seen(0, w)) continue;
+                scratch.mark(0, w);
+                next.push_back(w);
+            }
+        }
+        frontier.swap(next);
+    }
+
+    return frontier.size();
+}
+
+namespace
+{
+template <typename VertInd>
+struct bfs_meeting
+{
+    typename basic_graph<VertInd>::dist_t distance = basic_graph<VertInd>::max_dist;
+    VertInd forward = basic_graph<VertInd>::npos;
+    VertInd backward = basic_graph<VertInd>::npos;
+};
+
+template <typename Graph>
+bfs_meeting<typename Graph::vert_ind_t> bidirectional_bfs(Graph const& g, typename Graph::vert_ind_t src,
+                                                          typename Graph::vert_ind_t dst,
+                                                          basic_traversal_scratch<typename Graph::vert_ind_t>& sc)
+{
+    using graph_t = Graph;
+    using VertInd = typename Graph::vert_ind_t;
+
+    sc.start(g.num_vert(), 2, basic_traversal_scratch<VertInd>::vertex_state::labels);
+
+    sc.mark(0, src, 0, graph_t::npos);
+    sc.mark(1, dst, 0, graph_t::npos);
+    sc.frontier[0].push_back(src);
+    sc.frontier[1].push_back(dst);
+
+    bfs_meeting<VertInd> meeting;
+    if (src == dst)
+    {
+        meeting = {0, src, dst};
+        return meeting;
     }
 
-    for (graph::vert_ind_t v : g.neighbours_of(current_path.last()))
+    const bool search_backward = g.is_undirected();
+
+    while (not sc.frontier[0].empty() and not sc.frontier[1].empty())
     {
-        if (not current_path.would_loop(v))
+        const int side = (search_backward and sc.frontier[1].size() < sc.frontier[0].size()) ? 1 : 0;
+        const int other = 1 - side;
+
+        sc.next.clear();
+        for (auto u : sc.frontier[side])
+        {
+            const auto du = sc.dist[side][u];
+            for (auto w : g.neighbours_of(u))
+            {
+                if (not sc.seen(side, w))
+                {
+                    sc.mark(side, w, du + 1, u);
+                    sc.next.push_back(w);
+                }
+
+                if (sc.seen(other, w) and du + 1 + sc.dist[other][w] < meeting.distance)
+                {
+                    meeting.distance = du + 1 + sc.dist[other][w];
+                    meeting.forward = side == 0 ? u : w;
+                    meeting.backward = side == 0 ? w : u;
+                }
+            }
+        }
+        sc.frontier[side].swap(sc.next);
+
+        // Every meeting found while completing this level is a candidate, so
+        // the shortest of them is the answer once the level is done.
+        if (meeting.distance != graph_t::max_dist)
+            break;
+    }
+
+    return meeting;
+}
+}
+
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst)
+{
+    return distance_between(g, src, dst, thread_scratch<typename Graph::vert_ind_t>());
+}
+
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst,
+                 basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(src < g.num_vert());
+                           BOOST_CONTRACT_ASSERT(dst < g.num_vert()); });
+
+    return bidirectional_bfs(g, src, dst, scratch).distance;
+}
+
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst,
+                 typename Graph::path& p)
+{
+    return distance_between(g, src, dst, p, thread_scratch<typename Graph::vert_ind_t>());
+}
+
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst,
+                 typename Graph::path& p,
+                 basic_traversal_scratch<typename Graph::vert_ind_t>& sc)
+{
+    using graph_t = Graph;
+
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(src < g.num_vert());
+                           BOOST_CONTRACT_ASSERT(dst < g.num_vert()); });
+
+    const auto meeting = bidirectional_bfs(g, src, dst, sc);
+    sc.path.clear();
+
+    if (meeting.distance != graph_t::max_dist)
+    {
+        // src .. forward from the forward parents, then backward .. dst.
+        for (auto v = meeting.forward; v != graph_t::npos; v = sc.parent[0][v])
+            sc.path.push_back(v);
+        std::reverse(sc.path.begin(), sc.path.end());
+
+        if (meeting.backward != meeting.forward)
         {
-            //auto ext_path = current_path;
-            //ext_path.add_next(v);
-            paths_dfs_helper(g, out, current_path.extended_with(v), target);
+            for (auto v = meeting.backward; v != graph_t::npos; v = sc.parent[1][v])
+                sc.path.push_back(v);
         }
     }
+
+    p.assign(sc.path.begin(), sc.path.end());
+    return meeting.distance;
+}
+
+namespace
+{
+// Extends scratch.path, whose vertices are marked on side 0, depth first.
+template <typename Graph>
+void paths_dfs_helper(Graph const& g, std::vector<typename Graph::path>& out,
+                      basic_traversal_scratch<typename Graph::vert_ind_t>& scratch,
+                      typename Graph::vert_ind_t target)
+{
+    const auto last = scratch.path.back();
+    if (last == target)
+    {
+        out.emplace_back();
+        out.back().assign(scratch.path.begin(), scratch.path.end());
+        return;
+    }
+
+    for (auto v : g.neighbours_of(last))
+    {
+        if (scratch.seen(0, v)) continue;
+
+        scratch.mark(0, v);
+        scratch.path.push_back(v);
+        paths_dfs_helper(g, out, scratch, target);
+        scratch.path.pop_back();
+        scratch.unmark(0, v);
+    }
+}
 }
+
+template <typename Graph>
+std::vector<typename Graph::path>
+paths_between(Graph const& g,
+              typename Graph::vert_ind_t src,
+              typename Graph::vert_ind_t dst)
+{
+    return paths_between(g, src, dst, thread_scratch<typename Graph::vert_ind_t>());
 }
 
-std::vector<graph::path> paths_between(graph const& g, graph::vert_ind_t src, graph::vert_ind_t dst)
+template <typename Graph>
+std::vector<typename Graph::path>
+paths_between(Graph const& g,
+              typename Graph::vert_ind_t src,
+              typename Graph::vert_ind_t dst,
+              basic_traversal_scratch<typename Graph::vert_ind_t>& scratch)
 {
-    graph::path init;
-    init.add_next(src);
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(src < g.num_vert());
+                           BOOST_CONTRACT_ASSERT(dst < g.num_vert()); });
 
-    std::vector<graph::path> result;
+    std::vector<typename Graph::path> result;
 
-    paths_dfs_helper(g, result, init, dst);
+    scratch.start(g.num_vert());
+    scratch.path.assign(1, src);
+    scratch.mark(0, src);
+    paths_dfs_helper(g, result, scratch, dst);
 
     return result;
 }
 
+template <typename VertInd>
+basic_graph<VertInd> basic_graph<VertInd>::from_edges(std::size_t N, const std::vector<edge>& edges,
+                                                      const edge_build_options& options)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{
+                           for (const auto& e : edges)
+                           {
+                               BOOST_CONTRACT_ASSERT(e.source < N and e.target < N);
+                               BOOST_CONTRACT_ASSERT(e.weight >= 0);
+                           }
+                       });
+
+    const auto num_threads = detail::effective_thread_count(options.num_threads);
+    const bool sort_lists = options.sort_neighbours or options.drop_duplicates;
+
+    basic_graph g(N);
+    g.undirected = options.undirected;
+
+    auto kept = [&](const edge& e) { return not (options.drop_self_loops and e.source == e.target); };
+
+    // Weight lists are only built when some kept edge has a weight other than 1.
+    const bool weighted = std::any_of(edges.begin(), edges.end(),
+                                      [&](const edge& e) { return kept(e) and e.weight != 1; });
+    if (weighted)
+        g.weight_lists.resize(N);
+
+    // Degrees first, then the same counters serve as per-list write cursors.
+    std::vector<std::atomic<std::size_t>> fill(N);
+    detail::parallel_for_chunks(N, num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                        {
+                            for (auto v = begin; v < end; ++v)
+                                fill[v].store(0, std::memory_order_relaxed);
+                        });
+
+    detail::parallel_for_chunks(edges.size(), num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                        {
+                            for (auto i = begin; i < end; ++i)
+                            {
+                                const auto& e = edges[i];
+                                if (not kept(e)) continue;
+                                fill[e.source].fetch_add(1, std::memory_order_relaxed);
+                                if (options.undirected)
+                                    fill[e.target].fetch_add(1, std::memory_order_relaxed);
+                            }
+                        });
+
+    detail::parallel_for_chunks(N, num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                        {
+                            for (auto v = begin; v < end; ++v)
+                            {
+                                const auto degree = fill[v].load(std::memory_order_relaxed);
+                                g.adj_lists[v].resize(degree);
+                                if (weighted)
+                                    g.weight_lists[v].resize(degree);
+                                fill[v].store(0, std::memory_order_relaxed);
+                            }
+                        });
+
+    g.sorted = sort_lists or N == 0;
+    if (not sort_lists)
+    {
+        // Threads reach a vertex's edges in no particular order, so edge
+        // positions are scattered instead of targets, and each list is then
+        // filled from its positions in ascending order. Position 2 * i + 1
+        // stands for the reverse direction of edges[i].
+        std::vector<std::size_t> first(N + 1, 0);
+        for (std::size_t v = 0; v < N; ++v)
+            first[v + 1] = first[v] + g.adj_lists[v].size();
+
+        std::vector<std::size_t> positions(first[N]);
+        auto place_position = [&](VertInd source, std::size_t position)
+                              {
+                                  const auto slot = fill[source].fetch_add(1, std::memory_order_relaxed);
+                                  positions[first[source] + slot] = position;
+                              };
+
+        detail::parallel_for_chunks(edges.size(), num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                            {
+                                for (auto i = begin; i < end; ++i)
+                                {
+                                    const auto& e = edges[i];
+                                    if (not kept(e)) continue;
+                                    place_position(e.source, 2 * i);
+                                    if (options.undirected)
+                                        place_position(e.target, 2 * i + 1);
+                                }
+                            });
+
+        detail::parallel_for_chunks(N, num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                            {
+                                for (auto v = begin; v < end; ++v)
+                                {
+                                    const auto b = positions.begin() + static_cast<std::ptrdiff_t>(first[v]);
+                                    const auto e = positions.begin() + static_cast<std::ptrdiff_t>(first[v + 1]);
+                                    std::sort(b, e);
+                                    for (auto it = b; it != e; ++it)
+                                    {
+                                        const auto& edge = edges[*it / 2];
+                                        const auto slot = static_cast<std::size_t>(it - b);
+                                        g.adj_lists[v][slot] = *it % 2 == 0 ? edge.target : edge.source;
+                                        if (weighted)
+                                            g.weight_lists[v][slot] = edge.weight;
+                                    }
+                                }
+                            });
+
+        return g;
+    }
+
+    auto place = [&](VertInd source, VertInd target, weight_t w)
+                 {
+                     const auto slot = fill[source].fetch_add(1, std::memory_order_relaxed);
+                     g.adj_lists[source][slot] = target;
+                     if (weighted)
+                         g.weight_lists[source][slot] = w;
+                 };
+
+    detail::parallel_for_chunks(edges.size(), num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                        {
+                            for (auto i = begin; i < end; ++i)
+                            {
+                                const auto& e = edges[i];
+                                if (not kept(e)) continue;
+                                place(e.source, e.target, e.weight);
+                                if (options.undirected)
+                                    place(e.target, e.source, e.weight);
+                            }
+                        });
+
+    detail::parallel_for_chunks(N, num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                        {
+                            std::vector<std::pair<VertInd, weight_t>> entries;
+                            for (auto v = begin; v < end; ++v)
+                            {
+                                auto& l = g.adj_lists[v];
+                                if (not weighted)
+                                {
+                                    std::sort(l.begin(), l.end());
+                                    if (options.drop_duplicates)
+                                        l.erase(std::unique(l.begin(), l.end()), l.end());
+                                    continue;
+                                }
+
+                                auto& w = g.weight_lists[v];
+
+                                entries.clear();
+                                for (std::size_t i = 0; i < l.size(); ++i)
+                                    entries.emplace_back(l[i], w[i]);
+
+                                std::sort(entries.begin(), entries.end());
+                                if (options.drop_duplicates)
+                                {
+                                    auto same_target = [](const auto& a, const auto& b) { return a.first == b.first; };
+                                    entries.erase(std::unique(entries.begin(), entries.end(), same_target), entries.end());
+                                    l.resize(entries.size());
+                                    w.resize(entries.size());
+                                }
+
+                                for (std::size_t i = 0; i < entries.size(); ++i)
+                                {
+                                    l[i] = entries[i].first;
+                                    w[i] = entries[i].second;
+                                }
+                            }
+                        });
+
+    return g;
+}
+
+#define ALGO_INSTANTIATE_GRAPH_ALGORITHMS(VertInd)                                                   \
+    template basic_graph<VertInd> basic_graph<VertInd>::from_edges(                                    \
+        std::size_t, const std::vector<basic_graph<VertInd>::edge>&, const edge_build_options&);       \
+    template void print_undirected_graph<VertInd>(const basic_graph<VertInd>&, std::ostream&);        \
+    template matrix transitive_closure<VertInd>(basic_graph<VertInd> const&);                          \
+    template matrix adjacency_matrix<VertInd>(basic_graph<VertInd> const&);                            \
+    template matrix dense_transitive_closure<VertInd>(basic_graph<VertInd> const&);                    \
+    template matrix all_pairs_distances<VertInd>(basic_graph<VertInd> const&);                         \
+    template matrix all_pairs_weighted_distances<VertInd>(basic_graph<VertInd> const&);                \
+    template basic_graph<VertInd> k_cores<VertInd>(basic_graph<VertInd>, int);                         \
+    template std::vector<std::ptrdiff_t> delta_stepping_distances_from<VertInd>(                       \
+        basic_graph<VertInd> const&, VertInd, std::int32_t, unsigned);
+
+#define ALGO_INSTANTIATE_TRAVERSALS(Graph)                                                            \
+    template void bfs_for_each_visited<Graph>(const Graph&, Graph::vert_ind_t,                         \
+                                              std::function<void(Graph::vert_ind_t)>);                 \
+    template void bfs_for_each_visited<Graph>(const Graph&, Graph::vert_ind_t,                         \
+                                              std::function<void(Graph::vert_ind_t, Graph::vert_ind_t)>); \
+    template void bfs_for_each_visited<Graph>(const Graph&, Graph::vert_ind_t,                         \
+                                              std::function<void(Graph::vert_ind_t)>,                  \
+                                              basic_traversal_scratch<Graph::vert_ind_t>&);            \
+    template void bfs_for_each_visited<Graph>(const Graph&, Graph::vert_ind_t,                         \
+                                              std::function<void(Graph::vert_ind_t, Graph::vert_ind_t)>, \
+                                              basic_traversal_scratch<Graph::vert_ind_t>&);            \
+    template void dfs_for_each_visited<Graph>(const Graph&, Graph::vert_ind_t,                         \
+                                              std::function<void(Graph::vert_ind_t)>);                 \
+    template void dfs_for_each_visited<Graph>(const Graph&, Graph::vert_ind_t,                         \
+                                              std::function<void(Graph::vert_ind_t)>,                  \
+                                              basic_traversal_scratch<Graph::vert_ind_t>&);            \
+    template Graph::vert_ind_t find_mother_vertex<Graph>(const Graph&);                                \
+    template Graph::vert_ind_t find_mother_vertex<Graph>(const Graph&,                                 \
+                                                         basic_traversal_scratch<Graph::vert_ind_t>&); \
+    template std::vector<std::ptrdiff_t> distances_from<Graph>(Graph const&, Graph::vert_ind_t);       \
+    template std::vector<std::ptrdiff_t> distances_from<Graph>(Graph const&, Graph::vert_ind_t,        \
+                                                               basic_traversal_scratch<Graph::vert_ind_t>&); \
+    template std::vector<std::ptrdiff_t> weighted_distances_from<Graph>(Graph const&, Graph::vert_ind_t); \
+    template std::size_t count_verts_at_distance_from<Graph>(Graph const&, Graph::vert_ind_t,          \
+                                                             std::ptrdiff_t);                          \
+    template std::size_t count_verts_at_distance_from<Graph>(Graph const&, Graph::vert_ind_t,          \
+                                                             std::ptrdiff_t,                           \
+                                                             basic_traversal_scratch<Graph::vert_ind_t>&); \
+    template std::ptrdiff_t distance_between<Graph>(Graph const&, Graph::vert_ind_t, Graph::vert_ind_t); \
+    template std::ptrdiff_t distance_between<Graph>(Graph const&, Graph::vert_ind_t, Graph::vert_ind_t, \
+                                                    basic_traversal_scratch<Graph::vert_ind_t>&);      \
+    template std::ptrdiff_t distance_between<Graph>(Graph const&, Graph::vert_ind_t, Graph::vert_ind_t, \
+                                                    Graph::path&);                                     \
+    template std::ptrdiff_t distance_between<Graph>(Graph const&, Graph::vert_ind_t, Graph::vert_ind_t, \
+                                                    Graph::path&,                                      \
+                                                    basic_traversal_scratch<Graph::vert_ind_t>&);      \
+    template std::vector<Graph::path> paths_between<Graph>(Graph const&, Graph::vert_ind_t,            \
+                                                           Graph::vert_ind_t);                         \
+    template std::vector<Graph::path> paths_between<Graph>(Graph const&, Graph::vert_ind_t,            \
+                                                           Graph::vert_ind_t,                          \
+                                                           basic_traversal_scratch<Graph::vert_ind_t>&);
+
+ALGO_INSTANTIATE_GRAPH_ALGORITHMS(std::size_t)
+ALGO_INSTANTIATE_GRAPH_ALGORITHMS(std::uint32_t)
+
+ALGO_INSTANTIATE_TRAVERSALS(graph)
+ALGO_INSTANTIATE_TRAVERSALS(compact_graph)
+ALGO_INSTANTIATE_TRAVERSALS(block_graph)
+ALGO_INSTANTIATE_TRAVERSALS(compact_block_graph)
+
+#undef ALGO_INSTANTIATE_TRAVERSALS
+#undef ALGO_INSTANTIATE_GRAPH_ALGORITHMS
+
 }
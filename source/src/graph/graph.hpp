@@ -2,11 +2,15 @@
 
 #include <vector>
 #include <set>
+#include <algorithm>
+#include <cstdint>
 #include <iosfwd>
 #include <functional>
 #include <limits>
 #include <initializer_list>
 
+#include <boost/contract.hpp>
+
 namespace algo
 {
 
@@ -18,17 +22,100 @@ enum class cmp_res
     NEQ
 };
 
-class graph
+// Options for basic_graph::from_edges.
+struct edge_build_options
+{
+    // Store every edge in both directions, as add_undirected_edge does.
+    bool undirected = true;
+    // Sort each neighbour list, which makes has_edge and remove_edge binary
+    // searches. Unsorted lists keep the order of the edge array, as adding
+    // the edges one at a time would.
+    bool sort_neighbours = true;
+    // Keep one edge per (source, target) pair, the one with the lowest weight.
+    // Implies sort_neighbours.
+    bool drop_duplicates = true;
+    bool drop_self_loops = false;
+    // 0 uses all hardware threads.
+    unsigned num_threads = 0;
+};
+
+namespace detail
+{
+// Operations on one neighbour list and its weight list, shared by the graph
+// classes. weights is null while the graph is unweighted.
+
+// Appends target with weight w; returns false if this breaks ascending order.
+template <typename VertInd, typename Weight>
+bool append_to_list(std::vector<VertInd>& l, std::vector<Weight>* weights, VertInd target, Weight w)
+{
+    const bool in_order = l.empty() or l.back() <= target;
+    l.push_back(target);
+    if (weights) weights->push_back(w);
+    return in_order;
+}
+
+// Gives l unit weights, for a graph becoming weighted.
+template <typename VertInd, typename Weight>
+void assign_unit_weights(const std::vector<VertInd>& l, std::vector<Weight>& weights)
+{
+    weights.assign(l.size(), 1);
+}
+
+// Position of an entry equal to target, or l.size() if there is none.
+template <typename VertInd>
+std::size_t find_in_list(const std::vector<VertInd>& l, VertInd target, bool sorted)
+{
+    const auto it = sorted ? std::lower_bound(l.begin(), l.end(), target)
+                           : std::find(l.begin(), l.end(), target);
+    return it != l.end() and *it == target ? static_cast<std::size_t>(it - l.begin()) : l.size();
+}
+
+// Removes entry pos and its weight. Sorted lists keep their order; unsorted
+// ones have the last entry moved into the gap.
+template <typename VertInd, typename Weight>
+void erase_from_list(std::vector<VertInd>& l, std::vector<Weight>* weights, std::size_t pos, bool sorted)
+{
+    const auto offset = static_cast<std::ptrdiff_t>(pos);
+    if (sorted)
+    {
+        if (weights) weights->erase(weights->begin() + offset);
+        l.erase(l.begin() + offset);
+        return;
+    }
+
+    if (weights)
+    {
+        std::swap((*weights)[pos], weights->back());
+        weights->pop_back();
+    }
+    std::swap(l[pos], l.back());
+    l.pop_back();
+}
+}
+
+// VertInd is the unsigned type used for vertex indices in adjacency lists,
+// queues and paths; see graph and compact_graph below.
+template <typename VertInd>
+class basic_graph
 {
 public:
-    using vert_ind_t = std::size_t;
+    using vert_ind_t = VertInd;
     using adj_list_t = std::vector<vert_ind_t>;
     using sz_t = std::int64_t;
     using dist_t = std::ptrdiff_t;
+    using weight_t = std::int32_t;
+    using weight_list_t = std::vector<weight_t>;
 
     constexpr static vert_ind_t npos = std::numeric_limits<vert_ind_t>::max();
     constexpr static dist_t max_dist = std::numeric_limits<dist_t>::max();
 
+    struct edge
+    {
+        vert_ind_t source;
+        vert_ind_t target;
+        weight_t weight = 1;
+    };
+
     class path
     {
     public:
@@ -66,29 +153,52 @@ public:
             return path.back();
         }
 
+        // Replaces the path with [first, last) without the would_loop checks,
+        // for sequences known to be loop-free such as BFS parent chains.
+        template <typename It>
+        void assign(It first, It last)
+        {
+            path.assign(first, last);
+        }
+
     private:
         std::vector<vert_ind_t> path;
     };
 
-    graph(std::size_t N)
-        : adj_lists(N), undirected{true}
+    // Vertices are numbered 0 .. N - 1, so N must be below npos.
+    basic_graph(std::size_t N)
+        : adj_lists(checked_vertex_count(N)), undirected{true}, sorted{true}
     {}
 
+    // Builds the graph from an edge array in one pass: degrees are counted,
+    // every neighbour list is allocated exactly once and edges are scattered
+    // into place in parallel, followed by optional sorting and deduplication.
+    static basic_graph from_edges(std::size_t N, const std::vector<edge>& edges,
+                                  const edge_build_options& options = edge_build_options());
+
     vert_ind_t num_vert() const
     {
-        return adj_lists.size();
+        return static_cast<vert_ind_t>(adj_lists.size());
     }
 
-    void add_undirected_edge(vert_ind_t a, vert_ind_t b)
+    // Edge weights must be non-negative; this is checked here once, so the
+    // shortest-path algorithms need not scan the graph.
+    void add_undirected_edge(vert_ind_t a, vert_ind_t b, weight_t w = 1)
     {
-        adj_lists[a].insert(adj_lists[a].end(), b);
-        adj_lists[b].insert(adj_lists[b].end(), a);
+        boost::contract::check c = boost::contract::function()
+            .precondition([&]{ BOOST_CONTRACT_ASSERT(w >= 0); });
+
+        append(a, b, w);
+        append(b, a, w);
     }
 
-    void add_directed_edge(vert_ind_t source, vert_ind_t target)
+    void add_directed_edge(vert_ind_t source, vert_ind_t target, weight_t w = 1)
     {
+        boost::contract::check c = boost::contract::function()
+            .precondition([&]{ BOOST_CONTRACT_ASSERT(w >= 0); });
+
         undirected = false;
-        adj_lists[source].insert(adj_lists[source].end(), target);
+        append(source, target, w);
     }
 
     const adj_list_t& neighbours_of(vert_ind_t source) const
@@ -96,11 +206,37 @@ public:
         return adj_lists.at(source);
     }
 
+    // Weights are stored only once an edge with a weight other than 1 is
+    // added; until then every edge weighs 1 and no weight lists exist.
+    bool is_weighted() const
+    {
+        return not weight_lists.empty();
+    }
+
+    // weights_of(v)[i] is the weight of the edge to neighbours_of(v)[i];
+    // only for weighted graphs.
+    const weight_list_t& weights_of(vert_ind_t source) const
+    {
+        return weight_lists.at(source);
+    }
+
     bool is_undirected() const
     {
         return undirected;
     }
 
+    // True while every neighbour list is in ascending order.
+    bool has_sorted_neighbours() const
+    {
+        return sorted;
+    }
+
+    bool has_edge(vert_ind_t source, vert_ind_t target) const
+    {
+        const auto& l = adj_lists.at(source);
+        return detail::find_in_list(l, target, sorted) != l.size();
+    }
+
     sz_t degree_of(vert_ind_t v) const
     {
         return static_cast<sz_t>(adj_lists[v].size());
@@ -108,11 +244,11 @@ public:
 
     void remove_edge(vert_ind_t a, vert_ind_t b)
     {
-        remove_edge_from_list(adj_lists[a], b);
+        remove_edge_from_list(a, b);
 
         if (undirected)
         {
-            remove_edge_from_list(adj_lists[b], a);
+            remove_edge_from_list(b, a);
         }
     }
 
@@ -131,46 +267,211 @@ public:
         }
 
         adj_lists.erase(adj_lists.begin() + v);
+        if (is_weighted())
+            weight_lists.erase(weight_lists.begin() + v);
     }
 
 private:
-    void remove_edge_from_list(adj_list_t& l, vert_ind_t target)
+    // Checked before the lists are allocated.
+    static std::size_t checked_vertex_count(std::size_t N)
     {
-        auto it = std::find(l.begin(), l.end(), target);
+        boost::contract::check c = boost::contract::function()
+            .precondition([&]{ BOOST_CONTRACT_ASSERT(N < npos); });
 
-        if (it != l.end())
+        return N;
+    }
+
+    void append(vert_ind_t source, vert_ind_t target, weight_t w)
+    {
+        // Weight lists are created once the first edge not of unit weight arrives.
+        if (w != 1 and not is_weighted())
         {
-            std::swap(*it, l.back());
-            l.pop_back();
+            weight_lists.resize(adj_lists.size());
+            for (std::size_t v = 0; v < adj_lists.size(); ++v)
+                detail::assign_unit_weights(adj_lists[v], weight_lists[v]);
         }
+
+        auto* weights = is_weighted() ? &weight_lists[source] : nullptr;
+        if (not detail::append_to_list(adj_lists[source], weights, target, w))
+            sorted = false;
     }
 
+    void remove_edge_from_list(vert_ind_t source, vert_ind_t target)
+    {
+        auto& l = adj_lists[source];
+        const auto pos = detail::find_in_list(l, target, sorted);
+        if (pos != l.size())
+            detail::erase_from_list(l, is_weighted() ? &weight_lists[source] : nullptr, pos, sorted);
+    }
 
     std::vector<adj_list_t> adj_lists;
+    // Empty while the graph is unweighted, one list per vertex otherwise.
+    std::vector<weight_list_t> weight_lists;
     bool undirected;
+    bool sorted;
 };
 
 
+// Default graph with std::size_t vertex indices.
+using graph = basic_graph<std::size_t>;
+
+// Graph with 32-bit vertex indices, halving adjacency and traversal memory
+// for graphs below 2^32 vertices.
+using compact_graph = basic_graph<std::uint32_t>;
+
 std::vector<graph> undirected_graph_from_text_input(std::istream&);
-void print_undirected_graph(const graph&, std::ostream&);
 
-inline std::ostream& operator<<(std::ostream& out, const graph& g)
+template <typename VertInd>
+void print_undirected_graph(const basic_graph<VertInd>&, std::ostream&);
+
+template <typename VertInd>
+inline std::ostream& operator<<(std::ostream& out, const basic_graph<VertInd>& g)
 {
     print_undirected_graph(g, out);
     return out;
 }
 
-void bfs_for_each_visited(const graph&, graph::vert_ind_t, std::function<void(graph::vert_ind_t)>);
-void bfs_for_each_visited(const graph&, graph::vert_ind_t, std::function<void(graph::vert_ind_t, graph::vert_ind_t)>);
-void dfs_for_each_visited(const graph&, graph::vert_ind_t, std::function<void(graph::vert_ind_t)>);
+// Working memory for the traversals below. Passing one scratch to repeated
+// queries lets them reuse its visited marks, queues and path buffer instead of
+// allocating them per call; it grows to the largest graph it has been used
+// with, and only by the per-vertex arrays its traversals asked for.
+// Single-source searches use side 0, bidirectional searches both sides.
+// A scratch serves one traversal at a time.
+template <typename VertInd>
+struct basic_traversal_scratch
+{
+    using dist_t = typename basic_graph<VertInd>::dist_t;
+
+    // Per-vertex state a traversal keeps: visited marks only, or marks
+    // together with distances and parents.
+    enum class vertex_state { marks, labels };
+
+    // Entries are valid for the current traversal only when
+    // stamp[side][v] == generation, so starting one does not clear the arrays.
+    std::vector<std::uint32_t> stamp[2];
+    std::vector<dist_t> dist[2];
+    std::vector<VertInd> parent[2];
+    std::vector<VertInd> frontier[2];
+    std::vector<VertInd> next;
+    // The current DFS path, or the last path built from the parent arrays.
+    std::vector<VertInd> path;
+    std::uint32_t generation = 0;
+
+    // Allocates for graphs of up to nv vertices ahead of the first traversal.
+    void reserve(std::size_t nv, int sides = 1, vertex_state state = vertex_state::marks)
+    {
+        for (int side = 0; side < sides; ++side)
+        {
+            grow(side, nv, state);
+            frontier[side].reserve(nv);
+        }
+        next.reserve(nv);
+        path.reserve(nv);
+    }
+
+    // Starts a traversal of a graph with nv vertices, dropping all marks.
+    void start(std::size_t nv, int sides = 1, vertex_state state = vertex_state::marks)
+    {
+        for (int side = 0; side < sides; ++side)
+        {
+            grow(side, nv, state);
+            frontier[side].clear();
+        }
+
+        if (++generation == 0)
+        {
+            for (auto& st : stamp) std::fill(st.begin(), st.end(), 0);
+            generation = 1;
+        }
+    }
+
+    bool seen(int side, VertInd v) const
+    {
+        return stamp[side][v] == generation;
+    }
+
+    void mark(int side, VertInd v)
+    {
+        stamp[side][v] = generation;
+    }
+
+    // Only after start with vertex_state::labels.
+    void mark(int side, VertInd v, dist_t d, VertInd p)
+    {
+        stamp[side][v] = generation;
+        dist[side][v] = d;
+        parent[side][v] = p;
+    }
+
+    void unmark(int side, VertInd v)
+    {
+        stamp[side][v] = 0;
+    }
+
+private:
+    void grow(int side, std::size_t nv, vertex_state state)
+    {
+        if (stamp[side].size() < nv)
+            stamp[side].resize(nv, 0);
+
+        if (state == vertex_state::labels and dist[side].size() < nv)
+        {
+            dist[side].resize(nv);
+            parent[side].resize(nv);
+        }
+    }
+};
 
-graph::vert_ind_t find_mother_vertex(const graph& g);
+using traversal_scratch = basic_traversal_scratch<std::size_t>;
+using compact_traversal_scratch = basic_traversal_scratch<std::uint32_t>;
+
+// The traversals and distance queries below take any graph type with the read
+// interface of basic_graph; they are instantiated for basic_graph and for the
+// block graphs kept by versioned_graph. The overloads taking a scratch run the
+// same code on caller-provided working memory; the others use a scratch kept
+// per thread, so repeated queries do not allocate per-vertex state. The
+// callbacks of bfs_for_each_visited and dfs_for_each_visited may start another
+// traversal on the same thread.
+template <typename Graph>
+void bfs_for_each_visited(const Graph&, typename Graph::vert_ind_t,
+                          std::function<void(typename Graph::vert_ind_t)>);
+template <typename Graph>
+void bfs_for_each_visited(const Graph&, typename Graph::vert_ind_t,
+                          std::function<void(typename Graph::vert_ind_t)>,
+                          basic_traversal_scratch<typename Graph::vert_ind_t>&);
+template <typename Graph>
+void bfs_for_each_visited(const Graph&, typename Graph::vert_ind_t,
+                          std::function<void(typename Graph::vert_ind_t,
+                                             typename Graph::vert_ind_t)>);
+template <typename Graph>
+void bfs_for_each_visited(const Graph&, typename Graph::vert_ind_t,
+                          std::function<void(typename Graph::vert_ind_t,
+                                             typename Graph::vert_ind_t)>,
+                          basic_traversal_scratch<typename Graph::vert_ind_t>&);
+template <typename Graph>
+void dfs_for_each_visited(const Graph&, typename Graph::vert_ind_t,
+                          std::function<void(typename Graph::vert_ind_t)>);
+template <typename Graph>
+void dfs_for_each_visited(const Graph&, typename Graph::vert_ind_t,
+                          std::function<void(typename Graph::vert_ind_t)>,
+                          basic_traversal_scratch<typename Graph::vert_ind_t>&);
+
+template <typename Graph>
+typename Graph::vert_ind_t find_mother_vertex(const Graph& g);
+template <typename Graph>
+typename Graph::vert_ind_t find_mother_vertex(const Graph& g,
+                                              basic_traversal_scratch<typename Graph::vert_ind_t>& scratch);
 
 class matrix
 {
 public:
     using index_t = std::size_t;
-    using value_type = int;
+    // 64-bit so that weighted distances, sums of 32-bit edge weights, fit.
+    using value_type = std::int64_t;
+
+    // Distance standing for "unreachable" in min-plus products; small enough
+    // that the sum of two entries never overflows.
+    constexpr static value_type inf = std::numeric_limits<value_type>::max() / 2;
 
 private:
     struct row
@@ -186,12 +487,27 @@ private:
     };
 public:
     matrix(index_t r, index_t c, value_type v = 0);
-    matrix(std::initializer_list<std::initializer_list<int>>);
+    matrix(std::initializer_list<std::initializer_list<value_type>>);
 
     row operator[](index_t);
 
+    index_t num_rows() const { return rows; }
+    index_t num_cols() const { return cols; }
+
+    // Unchecked pointer to the cols contiguous entries of row r.
+    value_type* row_data(index_t r) { return data.data() + r * cols; }
+    const value_type* row_data(index_t r) const { return data.data() + r * cols; }
+
     cmp_res cmp(const matrix& rhs) const;
 
+    // Entry (i, j) is 1 if some k has non-zero (i, k) and (k, j), 0 otherwise.
+    // Operands are packed into 64-bit words and multiplied in cache blocks.
+    matrix boolean_product(const matrix& rhs) const;
+
+    // Entry (i, j) is the minimum over k of (i, k) + (k, j), saturated at inf.
+    // Operand entries above inf count as inf.
+    matrix min_plus_product(const matrix& rhs) const;
+
 private:
 
     index_t indices_to_offset(index_t, index_t);
@@ -205,13 +521,106 @@ private:
 inline bool operator==(matrix const& lhs, matrix const& rhs) { return (lhs.cmp(rhs) == cmp_res::EQ); }
 inline bool operator!=(matrix const& lhs, matrix const& rhs) { return not (lhs == rhs); }
 
-matrix transitive_closure(graph const& g);
-
-graph k_cores(graph g, int k);
-
-std::vector<graph::dist_t> distances_from(graph const& g, graph::vert_ind_t v);
-
-std::size_t count_verts_at_distance_from(graph const& g, graph::vert_ind_t v, graph::dist_t d);
-
-std::vector<graph::path> paths_between(graph const& g, graph::vert_ind_t src, graph::vert_ind_t dst);
+template <typename VertInd>
+matrix transitive_closure(basic_graph<VertInd> const& g);
+
+// Dense engine for small, dense graphs: V x V matrices built from the graph.
+
+// Entry (i, j) is 1 if there is an edge from i to j.
+template <typename VertInd>
+matrix adjacency_matrix(basic_graph<VertInd> const& g);
+
+// Same result as transitive_closure, by repeated boolean squaring.
+template <typename VertInd>
+matrix dense_transitive_closure(basic_graph<VertInd> const& g);
+
+// Hop distances between all pairs, matrix::inf where unreachable. Computed one
+// level at a time with boolean products, so cost grows with the diameter.
+template <typename VertInd>
+matrix all_pairs_distances(basic_graph<VertInd> const& g);
+
+// Weighted distances between all pairs by repeated min-plus squaring,
+// matrix::inf where unreachable.
+template <typename VertInd>
+matrix all_pairs_weighted_distances(basic_graph<VertInd> const& g);
+
+template <typename VertInd>
+basic_graph<VertInd> k_cores(basic_graph<VertInd> g, int k);
+
+template <typename Graph>
+std::vector<typename Graph::dist_t>
+distances_from(Graph const& g, typename Graph::vert_ind_t v);
+template <typename Graph>
+std::vector<typename Graph::dist_t>
+distances_from(Graph const& g, typename Graph::vert_ind_t v,
+               basic_traversal_scratch<typename Graph::vert_ind_t>& scratch);
+
+// Shortest path lengths over non-negative integer edge weights; unreachable
+// vertices get graph::max_dist. Serial Dijkstra driven by a radix heap.
+template <typename Graph>
+std::vector<typename Graph::dist_t>
+weighted_distances_from(Graph const& g, typename Graph::vert_ind_t v);
+
+// Same result as weighted_distances_from, computed by parallel delta-stepping.
+// delta == 0 picks the mean edge weight, num_threads == 0 uses all hardware threads.
+template <typename VertInd>
+std::vector<typename basic_graph<VertInd>::dist_t>
+delta_stepping_distances_from(basic_graph<VertInd> const& g, typename basic_graph<VertInd>::vert_ind_t v,
+                              typename basic_graph<VertInd>::weight_t delta = 0,
+                              unsigned num_threads = 0);
+
+template <typename Graph>
+std::size_t count_verts_at_distance_from(Graph const& g,
+                                         typename Graph::vert_ind_t v,
+                                         typename Graph::dist_t d);
+template <typename Graph>
+std::size_t count_verts_at_distance_from(Graph const& g,
+                                         typename Graph::vert_ind_t v,
+                                         typename Graph::dist_t d,
+                                         basic_traversal_scratch<typename Graph::vert_ind_t>& scratch);
+
+// Hop distance from src to dst, or graph::max_dist if dst is unreachable.
+// Undirected graphs are searched from both ends, always expanding the smaller
+// frontier; directed graphs fall back to a forward search that stops at dst.
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst);
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst,
+                 basic_traversal_scratch<typename Graph::vert_ind_t>& scratch);
+
+// As above, additionally storing one shortest path in p (left empty if
+// unreachable). The path is assembled in the scratch space and copied into p,
+// reusing p's storage.
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst,
+                 typename Graph::path& p);
+template <typename Graph>
+typename Graph::dist_t
+distance_between(Graph const& g,
+                 typename Graph::vert_ind_t src,
+                 typename Graph::vert_ind_t dst,
+                 typename Graph::path& p,
+                 basic_traversal_scratch<typename Graph::vert_ind_t>& scratch);
+
+// Every simple path from src to dst, in depth-first order.
+template <typename Graph>
+std::vector<typename Graph::path>
+paths_between(Graph const& g,
+              typename Graph::vert_ind_t src,
+              typename Graph::vert_ind_t dst);
+template <typename Graph>
+std::vector<typename Graph::path>
+paths_between(Graph const& g,
+              typename Graph::vert_ind_t src,
+              typename Graph::vert_ind_t dst,
+              basic_traversal_scratch<typename Graph::vert_ind_t>& scratch);
 }
@@ -1,9 +1,14 @@
 #include "graph.hpp"
+#include "test_graphs.hpp"
+#include "parallel.hpp"
 #include "catch.hpp"
 
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
 
 TEST_CASE("graph input")
 {
@@ -231,3 +236,390 @@ TEST_CASE("will return all paths between given vertices")
 
     REQUIRE(result == expected);
 }
+
+TEST_CASE("will compute weighted distances from a given vertex")
+{
+    algo::graph g(6);
+    g.add_undirected_edge(0, 1, 7);
+    g.add_undirected_edge(0, 2, 9);
+    g.add_undirected_edge(0, 5, 14);
+    g.add_undirected_edge(1, 2, 10);
+    g.add_undirected_edge(1, 3, 15);
+    g.add_undirected_edge(2, 3, 11);
+    g.add_undirected_edge(2, 5, 2);
+    g.add_undirected_edge(3, 4, 6);
+    g.add_undirected_edge(4, 5, 9);
+
+    const auto expected_distances = std::vector<algo::graph::dist_t>{0, 7, 9, 20, 20, 11};
+
+    REQUIRE(algo::weighted_distances_from(g, 0) == expected_distances);
+    REQUIRE(algo::delta_stepping_distances_from(g, 0) == expected_distances);
+    REQUIRE(algo::delta_stepping_distances_from(g, 0, 3, 4) == expected_distances);
+}
+
+TEST_CASE("weights are stored only once an edge is not of unit weight")
+{
+    algo::graph g(4);
+    g.add_undirected_edge(0, 1);
+    g.add_directed_edge(1, 2, 1);
+    REQUIRE(not g.is_weighted());
+    REQUIRE(algo::weighted_distances_from(g, 0) == algo::distances_from(g, 0));
+
+    g.add_undirected_edge(2, 3, 5);
+    REQUIRE(g.is_weighted());
+    REQUIRE(g.weights_of(1) == algo::graph::weight_list_t{1, 1});
+    REQUIRE(g.weights_of(2) == algo::graph::weight_list_t{5});
+    REQUIRE(algo::weighted_distances_from(g, 0) == std::vector<algo::graph::dist_t>{0, 1, 2, 7});
+
+    g.remove_edge(1, 0);
+    REQUIRE(g.weights_of(1) == algo::graph::weight_list_t{1});
+
+    const auto unit = algo::graph::from_edges(3, {{0, 1}, {1, 2}});
+    REQUIRE(not unit.is_weighted());
+    REQUIRE(algo::delta_stepping_distances_from(unit, 0) == std::vector<algo::graph::dist_t>{0, 1, 2});
+}
+
+TEST_CASE("weighted engines agree on a larger graph with unreachable vertices")
+{
+    const algo::graph::vert_ind_t n = 5000;
+    algo::graph g(n + 1);
+    for (const auto& e : algo::test::random_edges(n, 4 * n, 12345, 0, 99))
+    {
+        g.add_directed_edge(e.source, e.target, e.weight);
+    }
+
+    const auto serial = algo::weighted_distances_from(g, 0);
+
+    REQUIRE(serial[n] == algo::graph::max_dist);
+    REQUIRE(algo::delta_stepping_distances_from(g, 0, 0, 4) == serial);
+    REQUIRE(algo::delta_stepping_distances_from(g, 0, 1, 3) == serial);
+}
+
+TEST_CASE("delta-stepping handles weights far above delta")
+{
+    algo::graph g(3);
+    g.add_directed_edge(0, 1, 1000000000);
+    g.add_directed_edge(1, 2, 1000000000);
+
+    const auto expected = std::vector<algo::graph::dist_t>{0, 1000000000, 2000000000};
+    REQUIRE(algo::weighted_distances_from(g, 0) == expected);
+    REQUIRE(algo::delta_stepping_distances_from(g, 0, 1, 2) == expected);
+}
+
+TEST_CASE("parallel loops rethrow after every chunk has finished")
+{
+    const std::size_t count = 4 * algo::detail::min_parallel_count;
+    std::atomic<int> chunks_done{0};
+    auto body = [&](std::size_t, std::size_t, unsigned chunk)
+                {
+                    ++chunks_done;
+                    if (chunk % 2 == 0)
+                        throw std::runtime_error("chunk failed");
+                };
+
+    REQUIRE_THROWS_AS(algo::detail::parallel_for_chunks(count, 4, body), std::runtime_error);
+    REQUIRE(chunks_done == 4);
+
+    algo::detail::thread_team team(4);
+    chunks_done = 0;
+    REQUIRE_THROWS_AS(team.for_chunks(count, body), std::runtime_error);
+    REQUIRE(chunks_done == 4);
+
+    // The team is still usable after a failed loop.
+    std::atomic<std::size_t> covered{0};
+    team.for_chunks(count, [&](std::size_t begin, std::size_t end, unsigned) { covered += end - begin; });
+    REQUIRE(covered == count);
+}
+
+TEST_CASE("will compute distance and shortest path between two vertices")
+{
+    algo::graph g(8);
+    g.add_undirected_edge(0, 1);
+    g.add_undirected_edge(1, 2);
+    g.add_undirected_edge(2, 3);
+    g.add_undirected_edge(3, 4);
+    g.add_undirected_edge(0, 5);
+    g.add_undirected_edge(5, 4);
+
+    algo::graph::path p;
+    REQUIRE(algo::distance_between(g, 0, 4, p) == 2);
+    REQUIRE(p.get_verts() == std::vector<algo::graph::vert_ind_t>{0, 5, 4});
+
+    REQUIRE(algo::distance_between(g, 2, 2) == 0);
+    REQUIRE(algo::distance_between(g, 1, 3) == 2);
+    REQUIRE(algo::distance_between(g, 0, 7, p) == algo::graph::max_dist);
+    REQUIRE(p.get_verts().empty());
+
+    algo::graph dg(4);
+    dg.add_directed_edge(0, 1);
+    dg.add_directed_edge(1, 2);
+    dg.add_directed_edge(2, 3);
+    dg.add_directed_edge(3, 0);
+
+    REQUIRE(algo::distance_between(dg, 0, 3, p) == 3);
+    REQUIRE(p.get_verts() == std::vector<algo::graph::vert_ind_t>{0, 1, 2, 3});
+    REQUIRE(algo::distance_between(dg, 3, 2) == 3);
+}
+
+TEST_CASE("distance_between returns long shortest paths in order")
+{
+    const algo::graph::vert_ind_t n = 5000;
+    algo::graph g(n);
+    for (algo::graph::vert_ind_t v = 1; v < n; ++v)
+        g.add_undirected_edge(v - 1, v);
+
+    std::vector<algo::graph::vert_ind_t> expected(n);
+    std::iota(expected.begin(), expected.end(), 0);
+
+    algo::graph::path p;
+    REQUIRE(algo::distance_between(g, 0, n - 1, p) == static_cast<algo::graph::dist_t>(n - 1));
+    REQUIRE(p.get_verts() == expected);
+
+    std::reverse(expected.begin(), expected.end());
+    REQUIRE(algo::distance_between(g, n - 1, 0, p) == static_cast<algo::graph::dist_t>(n - 1));
+    REQUIRE(p.get_verts() == expected);
+}
+
+TEST_CASE("distance_between agrees with distances_from")
+{
+    const algo::graph::vert_ind_t n = 300;
+    const auto g = algo::test::random_graph(n, n, 42);
+
+    for (algo::graph::vert_ind_t s = 0; s < n; s += 37)
+    {
+        const auto dists = algo::distances_from(g, s);
+        for (algo::graph::vert_ind_t t = 0; t < n; ++t)
+        {
+            algo::graph::path p;
+            REQUIRE(algo::distance_between(g, s, t, p) == dists[t]);
+            if (dists[t] != algo::graph::max_dist)
+                REQUIRE(p.get_verts().size() == static_cast<std::size_t>(dists[t] + 1));
+        }
+    }
+}
+
+TEST_CASE("one scratch serves queries on graphs of different sizes")
+{
+    algo::graph small(3);
+    small.add_directed_edge(0, 1);
+    small.add_directed_edge(1, 2);
+
+    algo::graph large(10);
+    for (algo::graph::vert_ind_t v = 1; v < 10; ++v)
+        large.add_undirected_edge(v - 1, v);
+    large.add_undirected_edge(0, 9);
+
+    algo::traversal_scratch scratch;
+    for (int round = 0; round < 2; ++round)
+    {
+        REQUIRE(algo::distances_from(small, 0, scratch) == algo::distances_from(small, 0));
+        REQUIRE(algo::distances_from(large, 3, scratch) == algo::distances_from(large, 3));
+        REQUIRE(algo::count_verts_at_distance_from(large, 0, 2, scratch) == 2);
+        REQUIRE(algo::count_verts_at_distance_from(small, 2, algo::graph::max_dist, scratch) == 2);
+        REQUIRE(algo::find_mother_vertex(small, scratch) == 0);
+        REQUIRE(algo::find_mother_vertex(large, scratch) == 0);
+        REQUIRE(algo::paths_between(large, 0, 5, scratch).size() == 2);
+        REQUIRE(algo::distance_between(large, 2, 8, scratch) == 4);
+
+        std::size_t visited = 0;
+        algo::bfs_for_each_visited(large, 4, [&](algo::graph::vert_ind_t) { ++visited; }, scratch);
+        algo::dfs_for_each_visited(small, 1, [&](algo::graph::vert_ind_t) { ++visited; }, scratch);
+        REQUIRE(visited == 12u);
+    }
+}
+
+TEST_CASE("a traversal callback may start another traversal")
+{
+    algo::graph g(6);
+    for (algo::graph::vert_ind_t v = 1; v < 6; ++v)
+        g.add_directed_edge(v - 1, v);
+
+    std::vector<algo::graph::vert_ind_t> visited;
+    std::size_t reachable = 0;
+    algo::bfs_for_each_visited(g, 0, [&](algo::graph::vert_ind_t v)
+                               {
+                                   visited.push_back(v);
+                                   algo::dfs_for_each_visited(g, v, [&](algo::graph::vert_ind_t) { ++reachable; });
+                               });
+
+    REQUIRE(visited == (std::vector<algo::graph::vert_ind_t>{0, 1, 2, 3, 4, 5}));
+    REQUIRE(reachable == 6u + 5u + 4u + 3u + 2u + 1u);
+}
+
+TEST_CASE("compact graph with 32-bit indices gives the same answers")
+{
+    static_assert(sizeof(algo::compact_graph::adj_list_t::value_type) == 4, "compact graph stores 32-bit indices");
+
+    algo::graph g(6);
+    algo::compact_graph cg(6);
+    auto add_edge = [&](auto a, auto b)
+                    {
+                        g.add_directed_edge(a, b);
+                        cg.add_directed_edge(a, b);
+                    };
+    add_edge(0, 1);
+    add_edge(0, 2);
+    add_edge(1, 3);
+    add_edge(2, 3);
+    add_edge(3, 4);
+    add_edge(5, 0);
+
+    REQUIRE(algo::distances_from(cg, 0) == algo::distances_from(g, 0));
+    REQUIRE(algo::count_verts_at_distance_from(cg, 0, 2) == 1u);
+    REQUIRE(algo::find_mother_vertex(cg) == 5u);
+    REQUIRE(algo::paths_between(cg, 0, 4).size() == 2u);
+    REQUIRE(algo::distance_between(cg, 5, 4) == 4);
+
+    std::vector<algo::compact_graph::vert_ind_t> visited;
+    algo::bfs_for_each_visited(cg, 0, [&](auto v) { visited.push_back(v); });
+    REQUIRE(visited.size() == 5u);
+
+    REQUIRE(algo::k_cores(cg, 1).num_vert() == algo::k_cores(g, 1).num_vert());
+}
+
+TEST_CASE("boolean and min-plus matrix products")
+{
+    const algo::matrix a = {{1, 0, 1},
+                            {0, 0, 0},
+                            {0, 1, 0}};
+    const algo::matrix b = {{0, 1},
+                            {1, 0},
+                            {1, 1}};
+
+    const algo::matrix expected_boolean = {{1, 1},
+                                           {0, 0},
+                                           {1, 0}};
+    REQUIRE(a.boolean_product(b) == expected_boolean);
+
+    const auto inf = algo::matrix::inf;
+    const algo::matrix d = {{0, 3, inf},
+                            {inf, 0, 2},
+                            {1, inf, 0}};
+    const algo::matrix expected_min_plus = {{0, 3, 5},
+                                            {3, 0, 2},
+                                            {1, 4, 0}};
+    REQUIRE(d.min_plus_product(d) == expected_min_plus);
+
+    const auto max = std::numeric_limits<algo::matrix::value_type>::max();
+    const algo::matrix e = {{0, max},
+                            {max, 0}};
+    const algo::matrix expected_saturated = {{0, inf},
+                                             {inf, 0}};
+    REQUIRE(e.min_plus_product(e) == expected_saturated);
+}
+
+TEST_CASE("weighted all-pairs distances may exceed a single edge weight range")
+{
+    const algo::graph::weight_t w = 600000000;
+    algo::graph g(4);
+    g.add_directed_edge(0, 1, w);
+    g.add_directed_edge(1, 2, w);
+    g.add_directed_edge(2, 3, w);
+
+    const auto dists = algo::all_pairs_weighted_distances(g);
+    const auto expected = algo::weighted_distances_from(g, 0);
+    REQUIRE(expected[3] == 3 * algo::graph::dist_t{w});
+    for (algo::graph::vert_ind_t t = 0; t < 4; ++t)
+        REQUIRE(dists.row_data(0)[t] == expected[t]);
+    REQUIRE(dists.row_data(3)[0] == algo::matrix::inf);
+}
+
+TEST_CASE("dense engine agrees with per-vertex traversals")
+{
+    const algo::graph::vert_ind_t n = 150;
+    algo::graph g(n);
+    for (const auto& e : algo::test::random_edges(n, 2 * n, 7, 1, 9))
+    {
+        g.add_directed_edge(e.source, e.target, e.weight);
+    }
+
+    REQUIRE(algo::dense_transitive_closure(g) == algo::transitive_closure(g));
+
+    const auto adj = algo::adjacency_matrix(g);
+    for (algo::graph::vert_ind_t v : g.neighbours_of(0))
+        REQUIRE(adj.row_data(0)[v] == 1);
+
+    const auto hops = algo::all_pairs_distances(g);
+    const auto weighted = algo::all_pairs_weighted_distances(g);
+    for (algo::graph::vert_ind_t s = 0; s < n; ++s)
+    {
+        const auto expected_hops = algo::distances_from(g, s);
+        const auto expected_weighted = algo::weighted_distances_from(g, s);
+        for (algo::graph::vert_ind_t t = 0; t < n; ++t)
+        {
+            const auto as_matrix_entry = [](algo::graph::dist_t d)
+                                         {
+                                             return d == algo::graph::max_dist ? algo::matrix::inf
+                                                                               : static_cast<algo::matrix::value_type>(d);
+                                         };
+            REQUIRE(hops.row_data(s)[t] == as_matrix_entry(expected_hops[t]));
+            REQUIRE(weighted.row_data(s)[t] == as_matrix_entry(expected_weighted[t]));
+        }
+    }
+}
+
+TEST_CASE("bulk builder sorts neighbours and drops duplicates")
+{
+    using edge = algo::graph::edge;
+    const std::vector<edge> edges = {{0, 3, 5}, {0, 1, 2}, {1, 0, 7}, {2, 2, 1}, {3, 1, 4}, {0, 3, 1}};
+
+    algo::edge_build_options options;
+    options.drop_self_loops = true;
+    auto g = algo::graph::from_edges(4, edges, options);
+
+    REQUIRE(g.is_undirected());
+    REQUIRE(g.has_sorted_neighbours());
+    REQUIRE(g.neighbours_of(0) == algo::graph::adj_list_t{1, 3});
+    REQUIRE(g.weights_of(0) == algo::graph::weight_list_t{2, 1});
+    REQUIRE(g.neighbours_of(1) == algo::graph::adj_list_t{0, 3});
+    REQUIRE(g.neighbours_of(2).empty());
+    REQUIRE(g.has_edge(3, 0));
+    REQUIRE(not g.has_edge(3, 2));
+
+    g.remove_edge(0, 1);
+    REQUIRE(g.neighbours_of(0) == algo::graph::adj_list_t{3});
+    REQUIRE(g.neighbours_of(1) == algo::graph::adj_list_t{3});
+    REQUIRE(g.has_sorted_neighbours());
+
+    g.add_undirected_edge(3, 0);
+    REQUIRE(not g.has_sorted_neighbours());
+
+    algo::edge_build_options directed;
+    directed.undirected = false;
+    directed.sort_neighbours = false;
+    directed.drop_duplicates = false;
+    auto dg = algo::graph::from_edges(4, edges, directed);
+    REQUIRE(not dg.is_undirected());
+    REQUIRE(dg.degree_of(0) == 3);
+    REQUIRE(dg.degree_of(2) == 1);
+}
+
+TEST_CASE("bulk builder matches incremental construction on a large edge list")
+{
+    const algo::compact_graph::vert_ind_t n = 2000;
+    const auto edges = algo::test::random_edges(n, 20000, 99);
+    algo::compact_graph incremental(n);
+    for (const auto& e : edges)
+    {
+        incremental.add_undirected_edge(e.source, e.target);
+    }
+
+    algo::edge_build_options options;
+    options.drop_duplicates = false;
+    options.num_threads = 4;
+    const auto bulk = algo::compact_graph::from_edges(n, edges, options);
+
+    for (algo::compact_graph::vert_ind_t v = 0; v < n; ++v)
+    {
+        auto expected = incremental.neighbours_of(v);
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(bulk.neighbours_of(v) == expected);
+    }
+    REQUIRE(algo::distances_from(bulk, 0) == algo::distances_from(incremental, 0));
+
+    options.sort_neighbours = false;
+    const auto unsorted = algo::compact_graph::from_edges(n, edges, options);
+    REQUIRE(not unsorted.has_sorted_neighbours());
+    for (algo::compact_graph::vert_ind_t v = 0; v < n; ++v)
+        REQUIRE(unsorted.neighbours_of(v) == incremental.neighbours_of(v));
+}
@@ -0,0 +1,170 @@
+#include "neighbourhood_sketch.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+#include <boost/contract.hpp>
+
+namespace algo
+{
+
+double hll_params::relative_error() const
+{
+    return 1.04 / std::sqrt(static_cast<double>(std::size_t{1} << register_bits));
+}
+
+hll_params hll_params::for_relative_error(double err)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(err > 0.0); });
+
+    hll_params params;
+    params.register_bits = 4;
+    while (params.register_bits < 16 and params.relative_error() > err)
+        ++params.register_bits;
+    return params;
+}
+
+namespace
+{
+using hll_register_t = std::uint8_t;
+
+std::uint64_t mix(std::uint64_t x)
+{
+    // splitmix64 finaliser
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+class hll_estimator
+{
+public:
+    explicit hll_estimator(unsigned register_bits)
+        : m{std::size_t{1} << register_bits}
+    {
+        const auto md = static_cast<double>(m);
+        switch (m)
+        {
+        case 16: alpha = 0.673; break;
+        case 32: alpha = 0.697; break;
+        case 64: alpha = 0.709; break;
+        default: alpha = 0.7213 / (1.0 + 1.079 / md); break;
+        }
+
+        for (std::size_t r = 0; r < inverse_powers.size(); ++r)
+            inverse_powers[r] = std::ldexp(1.0, -static_cast<int>(r));
+    }
+
+    double estimate(const hll_register_t* registers) const
+    {
+        double sum = 0.0;
+        std::size_t zeros = 0;
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            sum += inverse_powers[registers[j]];
+            zeros += registers[j] == 0 ? 1 : 0;
+        }
+
+        const auto md = static_cast<double>(m);
+        const double raw = alpha * md * md / sum;
+        if (raw <= 2.5 * md and zeros != 0)
+            return md * std::log(md / static_cast<double>(zeros));
+        return raw;
+    }
+
+private:
+    std::size_t m;
+    double alpha;
+    std::array<double, 65> inverse_powers;
+};
+}
+
+template <typename VertInd>
+neighbourhood_sketch approximate_neighbourhood_sizes(basic_graph<VertInd> const& g,
+                                                     neighbourhood_sketch::dist_t max_distance,
+                                                     const hll_params& params)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{ BOOST_CONTRACT_ASSERT(max_distance >= 0);
+                           BOOST_CONTRACT_ASSERT(params.register_bits >= 4 and params.register_bits <= 16); });
+
+    const std::size_t nv = g.num_vert();
+    const unsigned b = params.register_bits;
+    const std::size_t m = std::size_t{1} << b;
+    const auto num_threads = detail::effective_thread_count(params.num_threads);
+    const hll_estimator estimator(b);
+
+    neighbourhood_sketch sketch(nv, max_distance);
+    std::vector<hll_register_t> current(nv * m, 0);
+    std::vector<hll_register_t> next(nv * m, 0);
+
+    // Ball of radius 0: each counter holds its own vertex. The top b hash
+    // bits pick the register, the position of the first set bit in the rest
+    // is the rank.
+    detail::parallel_for_chunks(nv, num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                                {
+                                    for (auto v = begin; v < end; ++v)
+                                    {
+                                        const auto h = mix(static_cast<std::uint64_t>(v) ^ mix(params.seed));
+                                        const auto index = static_cast<std::size_t>(h >> (64 - b));
+                                        const auto rest = h << b;
+                                        const auto rank = rest == 0 ? 64 - b + 1
+                                                                    : static_cast<unsigned>(__builtin_clzll(rest)) + 1;
+                                        current[v * m + index] = static_cast<hll_register_t>(std::min(rank, 64 - b + 1));
+                                        sketch.set_within(v, 0, estimator.estimate(&current[v * m]));
+                                    }
+                                });
+
+    neighbourhood_sketch::dist_t d = 1;
+    for (; d <= max_distance; ++d)
+    {
+        std::atomic<bool> changed{false};
+
+        detail::parallel_for_chunks(nv, num_threads, [&](std::size_t begin, std::size_t end, unsigned)
+                                    {
+                                        bool chunk_changed = false;
+                                        for (auto v = begin; v < end; ++v)
+                                        {
+                                            hll_register_t* out = &next[v * m];
+                                            const hll_register_t* own = &current[v * m];
+                                            std::copy(own, own + m, out);
+
+                                            for (auto u : g.neighbours_of(static_cast<VertInd>(v)))
+                                            {
+                                                const hll_register_t* in = &current[static_cast<std::size_t>(u) * m];
+                                                for (std::size_t j = 0; j < m; ++j)
+                                                    out[j] = std::max(out[j], in[j]);
+                                            }
+
+                                            chunk_changed = chunk_changed or not std::equal(out, out + m, own);
+                                            sketch.set_within(v, d, estimator.estimate(out));
+                                        }
+                                        if (chunk_changed) changed = true;
+                                    });
+
+        current.swap(next);
+        if (not changed)
+            break;
+    }
+
+    // Once no counter changes, every later ball is the same as the last one.
+    for (auto rest = d + 1; rest <= max_distance; ++rest)
+    {
+        for (std::size_t v = 0; v < nv; ++v)
+            sketch.set_within(v, rest, sketch.estimated_within(v, d));
+    }
+
+    return sketch;
+}
+
+template neighbourhood_sketch approximate_neighbourhood_sizes<std::size_t>(
+    basic_graph<std::size_t> const&, neighbourhood_sketch::dist_t, const hll_params&);
+template neighbourhood_sketch approximate_neighbourhood_sizes<std::uint32_t>(
+    basic_graph<std::uint32_t> const&, neighbourhood_sketch::dist_t, const hll_params&);
+
+}
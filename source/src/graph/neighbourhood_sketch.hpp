@@ -0,0 +1,82 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace algo
+{
+
+// Parameters of the HyperLogLog counters kept per vertex.
+struct hll_params
+{
+    // Each counter has 2^register_bits one-byte registers, in [4, 16].
+    unsigned register_bits = 6;
+    std::uint64_t seed = 0;
+    // 0 uses all hardware threads.
+    unsigned num_threads = 0;
+
+    // Relative standard error of a single estimate, 1.04 / sqrt(2^register_bits).
+    double relative_error() const;
+
+    // Smallest register count whose relative standard error is at most err.
+    static hll_params for_relative_error(double err);
+};
+
+// Estimated neighbourhood sizes of every vertex for distances 0..max_distance().
+class neighbourhood_sketch
+{
+public:
+    using dist_t = std::ptrdiff_t;
+
+    neighbourhood_sketch(std::size_t num_vert, dist_t max_distance)
+        : nv{num_vert}, max_d{max_distance}, within(num_vert * static_cast<std::size_t>(max_distance + 1), 0.0f)
+    {}
+
+    std::size_t num_vert() const { return nv; }
+    dist_t max_distance() const { return max_d; }
+
+    // Estimate of the number of vertices u with distance(v, u) <= d.
+    double estimated_within(std::size_t v, dist_t d) const
+    {
+        return within[offset(v, d)];
+    }
+
+    // Estimate of count_verts_at_distance_from(g, v, d).
+    double estimated_at(std::size_t v, dist_t d) const
+    {
+        const double previous = d == 0 ? 0.0 : estimated_within(v, d - 1);
+        const double at = estimated_within(v, d) - previous;
+        return at > 0.0 ? at : 0.0;
+    }
+
+    void set_within(std::size_t v, dist_t d, double estimate)
+    {
+        within[offset(v, d)] = static_cast<float>(estimate);
+    }
+
+private:
+    std::size_t offset(std::size_t v, dist_t d) const
+    {
+        return static_cast<std::size_t>(d) * nv + v;
+    }
+
+    std::size_t nv;
+    dist_t max_d;
+    std::vector<float> within;
+};
+
+// HyperANF: every vertex starts with a HyperLogLog counter holding itself, and
+// after t sweeps over the edges, in which each counter is merged with the
+// counters of its out-neighbours, it estimates the ball of radius t around the
+// vertex. Memory is two counter arrays of V * 2^register_bits bytes plus the
+// returned estimates; each sweep is split across threads by vertex range and
+// the register merges are byte-wise max loops.
+template <typename VertInd>
+neighbourhood_sketch approximate_neighbourhood_sizes(basic_graph<VertInd> const& g,
+                                                     neighbourhood_sketch::dist_t max_distance,
+                                                     const hll_params& params = hll_params());
+
+}
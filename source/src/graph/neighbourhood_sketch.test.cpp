@@ -0,0 +1,60 @@
+#include "neighbourhood_sketch.hpp"
+#include "test_graphs.hpp"
+#include "catch.hpp"
+
+#include <cmath>
+
+TEST_CASE("register count follows the requested error")
+{
+    REQUIRE(algo::hll_params::for_relative_error(0.2).register_bits == 5);
+    REQUIRE(algo::hll_params::for_relative_error(0.02).register_bits == 12);
+    REQUIRE(algo::hll_params::for_relative_error(1e-9).register_bits == 16);
+}
+
+TEST_CASE("sketch estimates neighbourhood sizes within the expected error")
+{
+    const algo::graph::vert_ind_t n = 400;
+    // A cycle with random chords.
+    algo::graph g(n);
+    for (algo::graph::vert_ind_t i = 0; i < n; ++i)
+        g.add_undirected_edge(i, (i + 1) % n);
+    for (const auto& e : algo::test::random_edges(n, n / 3, 5))
+        g.add_undirected_edge(e.source, e.target);
+
+    algo::hll_params params;
+    params.register_bits = 10;
+    params.num_threads = 2;
+    const algo::graph::dist_t max_d = 12;
+    const auto sketch = algo::approximate_neighbourhood_sizes(g, max_d, params);
+
+    REQUIRE(sketch.num_vert() == n);
+    REQUIRE(sketch.max_distance() == max_d);
+
+    // Allow four standard errors, plus one vertex of slack for tiny balls.
+    const double tolerance = 4 * params.relative_error();
+    for (algo::graph::vert_ind_t v = 0; v < n; v += 41)
+    {
+        std::size_t within = 0;
+        for (algo::graph::dist_t d = 0; d <= max_d; ++d)
+        {
+            const auto at = algo::count_verts_at_distance_from(g, v, d);
+            within += at;
+            REQUIRE(std::abs(sketch.estimated_within(v, d) - static_cast<double>(within))
+                    <= tolerance * static_cast<double>(within) + 1.0);
+        }
+        REQUIRE(sketch.estimated_at(v, 0) == Approx(1.0).margin(0.5));
+    }
+}
+
+TEST_CASE("sketch keeps the final estimate once neighbourhoods stop growing")
+{
+    algo::compact_graph g(3);
+    g.add_directed_edge(0, 1);
+    g.add_directed_edge(1, 2);
+
+    const auto sketch = algo::approximate_neighbourhood_sizes(g, 6);
+
+    REQUIRE(sketch.estimated_within(0, 6) == Approx(3.0).margin(0.5));
+    REQUIRE(sketch.estimated_within(2, 6) == Approx(1.0).margin(0.5));
+    REQUIRE(sketch.estimated_at(0, 4) == Approx(0.0).margin(0.5));
+}
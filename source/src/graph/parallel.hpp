@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace algo
+{
+namespace detail
+{
+
+// Ranges below this size are handled on the calling thread to avoid
+// synchronisation overhead.
+constexpr std::size_t min_parallel_count = 1024;
+
+// Keeps the first exception thrown by any of the threads of a parallel loop,
+// so it can be rethrown on the calling thread once they have all finished.
+class first_exception
+{
+public:
+    template <typename F>
+    void run(F&& f) noexcept
+    {
+        try
+        {
+            f();
+        }
+        catch (...)
+        {
+            capture();
+        }
+    }
+
+    void capture() noexcept
+    {
+        std::lock_guard<std::mutex> lk(lock);
+        if (not error) error = std::current_exception();
+    }
+
+    void rethrow_if_any()
+    {
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    std::mutex lock;
+    std::exception_ptr error;
+};
+
+// Runs f(begin, end, chunk) over [0, count) split into num_threads chunks;
+// small ranges are handled on the calling thread to avoid spawn overhead.
+// If any chunk throws, the first exception is rethrown after every thread
+// has been joined.
+template <typename F>
+void parallel_for_chunks(std::size_t count, unsigned num_threads, F f)
+{
+    if (num_threads <= 1 or count < min_parallel_count)
+    {
+        f(std::size_t{0}, count, 0u);
+        return;
+    }
+
+    const std::size_t chunk = (count + num_threads - 1) / num_threads;
+    first_exception error;
+    auto run_chunk = [&](unsigned t)
+                     {
+                         const auto begin = std::min(count, t * chunk);
+                         error.run([&]{ f(begin, std::min(count, begin + chunk), t); });
+                     };
+
+    std::vector<std::thread> workers;
+    try
+    {
+        workers.reserve(num_threads - 1);
+        for (unsigned t = 1; t < num_threads; ++t)
+            workers.emplace_back(run_chunk, t);
+        run_chunk(0);
+    }
+    catch (...)
+    {
+        // Starting a thread failed; the chunks it would have run are lost.
+        error.capture();
+    }
+
+    for (auto& w : workers) w.join();
+    error.rethrow_if_any();
+}
+
+// Threads started once and reused for many parallel_for_chunks-style loops,
+// for algorithms that run a long sequence of short parallel phases.
+class thread_team
+{
+public:
+    explicit thread_team(unsigned num_threads)
+    {
+        try
+        {
+            for (unsigned t = 1; t < num_threads; ++t)
+                helpers.emplace_back([this, t] { serve(t); });
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    ~thread_team()
+    {
+        stop();
+    }
+
+    thread_team(const thread_team&) = delete;
+    thread_team& operator=(const thread_team&) = delete;
+
+    unsigned size() const
+    {
+        return static_cast<unsigned>(helpers.size()) + 1;
+    }
+
+    // Same contract as parallel_for_chunks with size() threads; chunk 0 runs
+    // on the calling thread.
+    template <typename F>
+    void for_chunks(std::size_t count, F f)
+    {
+        const unsigned n = size();
+        if (n == 1 or count < min_parallel_count)
+        {
+            f(std::size_t{0}, count, 0u);
+            return;
+        }
+
+        const std::size_t chunk = (count + n - 1) / n;
+        first_exception error;
+        const std::function<void(unsigned)> run_chunk = [&](unsigned t)
+                                                        {
+                                                            const auto begin = std::min(count, t * chunk);
+                                                            error.run([&]{ f(begin, std::min(count, begin + chunk), t); });
+                                                        };
+        {
+            std::lock_guard<std::mutex> lk(lock);
+            job = &run_chunk;
+            running = n - 1;
+            ++generation;
+        }
+        start.notify_all();
+
+        run_chunk(0);
+
+        // The helpers use run_chunk until they report back, even on error.
+        {
+            std::unique_lock<std::mutex> lk(lock);
+            finished.wait(lk, [&]{ return running == 0; });
+            job = nullptr;
+        }
+        error.rethrow_if_any();
+    }
+
+private:
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lk(lock);
+            stopping = true;
+        }
+        start.notify_all();
+
+        for (auto& h : helpers) h.join();
+    }
+
+    void serve(unsigned t)
+    {
+        std::uint64_t seen = 0;
+        while (true)
+        {
+            const std::function<void(unsigned)>* current;
+            {
+                std::unique_lock<std::mutex> lk(lock);
+                start.wait(lk, [&]{ return stopping or generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                current = job;
+            }
+
+            (*current)(t);
+
+            std::lock_guard<std::mutex> lk(lock);
+            if (--running == 0)
+                finished.notify_one();
+        }
+    }
+
+    std::vector<std::thread> helpers;
+    std::mutex lock;
+    std::condition_variable start;
+    std::condition_variable finished;
+    const std::function<void(unsigned)>* job = nullptr;
+    unsigned running = 0;
+    std::uint64_t generation = 0;
+    bool stopping = false;
+};
+
+inline unsigned effective_thread_count(unsigned requested)
+{
+    if (requested != 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+}
+}
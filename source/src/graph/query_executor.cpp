@@ -0,0 +1,300 @@
+#include "query_executor.hpp"
+#include "parallel.hpp"
+
+#include <exception>
+#include <type_traits>
+
+#include <boost/contract.hpp>
+
+namespace algo
+{
+
+template <typename VertInd>
+struct basic_query_executor<VertInd>::batch_state
+{
+    std::vector<query> queries;
+    // One promise per query, or on_result when the caller asked for callbacks.
+    std::vector<std::promise<result>> promises;
+    result_callback on_result;
+
+    std::promise<batch_stats> stats;
+    std::chrono::steady_clock::time_point submitted;
+    std::atomic<std::size_t> remaining{0};
+    std::array<std::atomic<std::size_t>, 32> latency_histogram{};
+
+    std::mutex error_lock;
+    std::exception_ptr error;
+};
+
+template <typename VertInd>
+basic_query_executor<VertInd>::basic_query_executor(const graph_t& g_init, unsigned num_workers_init)
+    : g{g_init}
+{
+    num_workers_init = detail::effective_thread_count(num_workers_init);
+
+    const std::size_t nv = g.num_vert();
+    for (unsigned i = 0; i < num_workers_init; ++i)
+    {
+        auto w = std::make_unique<worker>();
+        w->space.reserve(nv);
+        workers.push_back(std::move(w));
+    }
+
+    try
+    {
+        for (std::size_t i = 0; i < workers.size(); ++i)
+            workers[i]->thread = std::thread([this, i] { run(i); });
+    }
+    catch (...)
+    {
+        // The destructor will not run; stop the workers that did start.
+        stop();
+        throw;
+    }
+}
+
+template <typename VertInd>
+basic_query_executor<VertInd>::~basic_query_executor()
+{
+    stop();
+}
+
+template <typename VertInd>
+void basic_query_executor<VertInd>::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& w : workers)
+    {
+        if (w->thread.joinable())
+            w->thread.join();
+    }
+}
+
+template <typename VertInd>
+bool basic_query_executor<VertInd>::in_range(const query& q) const
+{
+    const auto nv = g.num_vert();
+    return std::visit([nv](const auto& alternative)
+                      {
+                          using alternative_t = std::decay_t<decltype(alternative)>;
+                          if constexpr (std::is_same_v<alternative_t, mother_vertex_query>)
+                              return true;
+                          else if constexpr (std::is_same_v<alternative_t, paths_query>)
+                              return alternative.source < nv and alternative.target < nv;
+                          else
+                              return alternative.source < nv;
+                      }, q);
+}
+
+template <typename VertInd>
+typename basic_query_executor<VertInd>::batch_handle
+basic_query_executor<VertInd>::submit(std::vector<query> batch)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{
+                           for (const auto& q : batch)
+                           {
+                               BOOST_CONTRACT_ASSERT(in_range(q));
+                           }
+                       });
+
+    auto state = std::make_shared<batch_state>();
+    state->queries = std::move(batch);
+    state->promises.resize(state->queries.size());
+
+    batch_handle handle;
+    handle.results.reserve(state->promises.size());
+    for (auto& p : state->promises)
+        handle.results.push_back(p.get_future());
+    handle.stats = state->stats.get_future();
+
+    enqueue(std::move(state));
+    return handle;
+}
+
+template <typename VertInd>
+std::future<typename basic_query_executor<VertInd>::batch_stats>
+basic_query_executor<VertInd>::submit(std::vector<query> batch, result_callback on_result)
+{
+    boost::contract::check c = boost::contract::function()
+        .precondition([&]{
+                           BOOST_CONTRACT_ASSERT(static_cast<bool>(on_result));
+                           for (const auto& q : batch)
+                           {
+                               BOOST_CONTRACT_ASSERT(in_range(q));
+                           }
+                       });
+
+    auto state = std::make_shared<batch_state>();
+    state->queries = std::move(batch);
+    state->on_result = std::move(on_result);
+
+    auto stats = state->stats.get_future();
+    enqueue(std::move(state));
+    return stats;
+}
+
+template <typename VertInd>
+void basic_query_executor<VertInd>::enqueue(std::shared_ptr<batch_state> batch)
+{
+    const auto n = batch->queries.size();
+    batch->remaining = n;
+    batch->submitted = std::chrono::steady_clock::now();
+
+    if (n == 0)
+    {
+        batch->stats.set_value(batch_stats());
+        return;
+    }
+
+    // Contiguous slices keep neighbouring queries on one worker; the first
+    // slice rotates between batches so small batches spread over the pool.
+    const auto nw = workers.size();
+    const auto slice = (n + nw - 1) / nw;
+    const auto first_worker = next_worker++ % nw;
+    for (std::size_t s = 0; s * slice < n; ++s)
+    {
+        auto& w = *workers[(first_worker + s) % nw];
+        std::lock_guard<std::mutex> lk(w.lock);
+        for (auto i = s * slice; i < std::min(n, (s + 1) * slice); ++i)
+            w.tasks.push_back(task{batch, i});
+    }
+
+    // Counted only once queued, so woken workers find the tasks.
+    {
+        std::lock_guard<std::mutex> lk(sleep_lock);
+        pending += static_cast<std::ptrdiff_t>(n);
+    }
+    wake.notify_all();
+}
+
+template <typename VertInd>
+bool basic_query_executor<VertInd>::take_task(std::size_t self, task& out)
+{
+    const auto nw = workers.size();
+    for (std::size_t k = 0; k < nw; ++k)
+    {
+        auto& w = *workers[(self + k) % nw];
+        std::lock_guard<std::mutex> lk(w.lock);
+        if (w.tasks.empty()) continue;
+
+        // Own work from the front, stolen work from the back.
+        if (k == 0)
+        {
+            out = std::move(w.tasks.front());
+            w.tasks.pop_front();
+        }
+        else
+        {
+            out = std::move(w.tasks.back());
+            w.tasks.pop_back();
+        }
+        --pending;
+        return true;
+    }
+    return false;
+}
+
+template <typename VertInd>
+void basic_query_executor<VertInd>::run(std::size_t self)
+{
+    while (true)
+    {
+        task t;
+        if (take_task(self, t))
+        {
+            execute(self, t);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(sleep_lock);
+        wake.wait(lk, [&]{ return stopping or pending > 0; });
+        if (stopping and pending <= 0)
+            return;
+    }
+}
+
+template <typename VertInd>
+void basic_query_executor<VertInd>::execute(std::size_t self, const task& t)
+{
+    auto& b = *t.batch;
+
+    try
+    {
+        auto r = answer(workers[self]->space, b.queries[t.index]);
+        if (b.on_result)
+            b.on_result(t.index, std::move(r));
+        else
+            b.promises[t.index].set_value(std::move(r));
+    }
+    catch (...)
+    {
+        if (b.on_result)
+        {
+            std::lock_guard<std::mutex> lk(b.error_lock);
+            if (not b.error) b.error = std::current_exception();
+        }
+        else
+        {
+            b.promises[t.index].set_exception(std::current_exception());
+        }
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - b.submitted).count();
+    std::size_t bucket = 0;
+    while (bucket + 1 < b.latency_histogram.size() and (micros >> (bucket + 1)) > 0) ++bucket;
+    b.latency_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    if (b.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    batch_stats stats;
+    stats.num_queries = b.queries.size();
+    stats.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(now - b.submitted);
+    const auto seconds = std::chrono::duration<double>(stats.wall_time).count();
+    stats.queries_per_second = seconds > 0.0 ? static_cast<double>(stats.num_queries) / seconds : 0.0;
+    for (std::size_t i = 0; i < stats.latency_histogram.size(); ++i)
+        stats.latency_histogram[i] = b.latency_histogram[i].load(std::memory_order_relaxed);
+
+    if (b.error)
+        b.stats.set_exception(b.error);
+    else
+        b.stats.set_value(stats);
+}
+
+template <typename VertInd>
+typename basic_query_executor<VertInd>::result
+basic_query_executor<VertInd>::answer(basic_traversal_scratch<VertInd>& space, const query& q) const
+{
+    return std::visit([&](const auto& alternative) -> result
+                      {
+                          using alternative_t = std::decay_t<decltype(alternative)>;
+                          if constexpr (std::is_same_v<alternative_t, distances_query>)
+                          {
+                              return distances_from(g, alternative.source, space);
+                          }
+                          else if constexpr (std::is_same_v<alternative_t, count_at_distance_query>)
+                          {
+                              return count_verts_at_distance_from(g, alternative.source, alternative.distance, space);
+                          }
+                          else if constexpr (std::is_same_v<alternative_t, mother_vertex_query>)
+                          {
+                              return mother_vertex_result{find_mother_vertex(g, space)};
+                          }
+                          else
+                          {
+                              return paths_between(g, alternative.source, alternative.target, space);
+                          }
+                      }, q);
+}
+
+template class basic_query_executor<std::size_t>;
+template class basic_query_executor<std::uint32_t>;
+
+}
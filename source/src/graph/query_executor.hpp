@@ -0,0 +1,126 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace algo
+{
+
+// Runs batches of independent queries against one graph on a fixed pool of
+// worker threads. Each worker owns a deque of tasks and steals from the
+// others when its own runs dry, and keeps traversal scratch sized to the
+// graph, so queries do not allocate visited sets or queues. The graph must
+// outlive the executor and must not be modified while it is in use.
+template <typename VertInd>
+class basic_query_executor
+{
+public:
+    using graph_t = basic_graph<VertInd>;
+    using vert_ind_t = typename graph_t::vert_ind_t;
+    using dist_t = typename graph_t::dist_t;
+
+    // Same answers as distances_from, count_verts_at_distance_from,
+    // find_mother_vertex and paths_between respectively.
+    struct distances_query { vert_ind_t source; };
+    struct count_at_distance_query { vert_ind_t source; dist_t distance; };
+    struct mother_vertex_query {};
+    struct paths_query { vert_ind_t source; vert_ind_t target; };
+
+    struct mother_vertex_result { vert_ind_t vertex; };
+
+    using query = std::variant<distances_query, count_at_distance_query, mother_vertex_query, paths_query>;
+    // Holds the alternative matching the query at the same index.
+    using result = std::variant<std::vector<dist_t>, std::size_t, mother_vertex_result,
+                                std::vector<typename graph_t::path>>;
+
+    struct batch_stats
+    {
+        std::size_t num_queries = 0;
+        std::chrono::nanoseconds wall_time{0};
+        double queries_per_second = 0.0;
+        // latency_histogram[i] counts queries that completed between 2^i and
+        // 2^(i+1) microseconds after the batch was submitted; bucket 0 also
+        // holds everything under a microsecond.
+        std::array<std::size_t, 32> latency_histogram{};
+    };
+
+    struct batch_handle
+    {
+        std::vector<std::future<result>> results;
+        std::future<batch_stats> stats;
+    };
+
+    using result_callback = std::function<void(std::size_t, result)>;
+
+    // num_workers == 0 uses all hardware threads.
+    explicit basic_query_executor(const graph_t& g, unsigned num_workers = 0);
+    ~basic_query_executor();
+
+    basic_query_executor(const basic_query_executor&) = delete;
+    basic_query_executor& operator=(const basic_query_executor&) = delete;
+
+    // Results are delivered through one future per query.
+    batch_handle submit(std::vector<query> batch);
+
+    // on_result(index, result) is called on a worker thread as each query
+    // completes; the returned future becomes ready after the last call.
+    std::future<batch_stats> submit(std::vector<query> batch, result_callback on_result);
+
+    unsigned num_workers() const
+    {
+        return static_cast<unsigned>(workers.size());
+    }
+
+private:
+    struct batch_state;
+
+    struct task
+    {
+        std::shared_ptr<batch_state> batch;
+        std::size_t index;
+    };
+
+    struct worker
+    {
+        std::mutex lock;
+        std::deque<task> tasks;
+        basic_traversal_scratch<VertInd> space;
+        std::thread thread;
+    };
+
+    // Wakes the workers to exit and joins those that were started.
+    void stop();
+    bool in_range(const query& q) const;
+    void enqueue(std::shared_ptr<batch_state> batch);
+    bool take_task(std::size_t self, task& out);
+    void run(std::size_t self);
+    void execute(std::size_t self, const task& t);
+    result answer(basic_traversal_scratch<VertInd>& space, const query& q) const;
+
+    const graph_t& g;
+    std::vector<std::unique_ptr<worker>> workers;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    // Queued tasks; a worker may take a task before enqueue has counted it,
+    // so the count can briefly go negative.
+    std::atomic<std::ptrdiff_t> pending{0};
+    std::atomic<std::size_t> next_worker{0};
+    bool stopping = false;
+};
+
+using query_executor = basic_query_executor<std::size_t>;
+using compact_query_executor = basic_query_executor<std::uint32_t>;
+
+}
@@ -0,0 +1,96 @@
+#include "query_executor.hpp"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <set>
+
+namespace
+{
+algo::graph example_graph()
+{
+    algo::graph g(7);
+    g.add_directed_edge(0, 1);
+    g.add_directed_edge(0, 2);
+    g.add_directed_edge(1, 3);
+    g.add_directed_edge(4, 1);
+    g.add_directed_edge(6, 4);
+    g.add_directed_edge(5, 6);
+    g.add_directed_edge(5, 2);
+    g.add_directed_edge(6, 0);
+    g.add_directed_edge(2, 3);
+    return g;
+}
+}
+
+TEST_CASE("executor answers a mixed batch like the single-query functions")
+{
+    using executor = algo::query_executor;
+    const auto g = example_graph();
+    executor ex(g, 3);
+
+    std::vector<executor::query> batch;
+    for (algo::graph::vert_ind_t v = 0; v < g.num_vert(); ++v)
+    {
+        batch.push_back(executor::distances_query{v});
+        batch.push_back(executor::count_at_distance_query{v, 2});
+        batch.push_back(executor::count_at_distance_query{v, algo::graph::max_dist});
+        batch.push_back(executor::paths_query{v, 3});
+    }
+    batch.push_back(executor::mother_vertex_query{});
+
+    auto handle = ex.submit(batch);
+    REQUIRE(handle.results.size() == batch.size());
+
+    for (algo::graph::vert_ind_t v = 0; v < g.num_vert(); ++v)
+    {
+        REQUIRE(std::get<std::vector<algo::graph::dist_t>>(handle.results[4 * v].get()) == algo::distances_from(g, v));
+        REQUIRE(std::get<std::size_t>(handle.results[4 * v + 1].get()) == algo::count_verts_at_distance_from(g, v, 2));
+        REQUIRE(std::get<std::size_t>(handle.results[4 * v + 2].get())
+                == algo::count_verts_at_distance_from(g, v, algo::graph::max_dist));
+
+        auto as_verts = [](const std::vector<algo::graph::path>& paths)
+                        {
+                            std::set<std::vector<algo::graph::vert_ind_t>> verts;
+                            for (const auto& p : paths) verts.insert(p.get_verts());
+                            return verts;
+                        };
+        const auto paths = std::get<std::vector<algo::graph::path>>(handle.results[4 * v + 3].get());
+        REQUIRE(as_verts(paths) == as_verts(algo::paths_between(g, v, 3)));
+    }
+    REQUIRE(std::get<executor::mother_vertex_result>(handle.results.back().get()).vertex == 5u);
+
+    const auto stats = handle.stats.get();
+    REQUIRE(stats.num_queries == batch.size());
+    REQUIRE(std::accumulate(stats.latency_histogram.begin(), stats.latency_histogram.end(), std::size_t{0})
+            == batch.size());
+}
+
+TEST_CASE("executor delivers results through callbacks")
+{
+    using executor = algo::compact_query_executor;
+    algo::compact_graph g(1000);
+    for (algo::compact_graph::vert_ind_t v = 1; v < g.num_vert(); ++v)
+        g.add_undirected_edge(v - 1, v);
+
+    executor ex(g, 4);
+    std::vector<executor::query> batch;
+    for (algo::compact_graph::vert_ind_t v = 0; v < g.num_vert(); ++v)
+        batch.push_back(executor::count_at_distance_query{v, 10});
+
+    std::mutex lock;
+    std::vector<std::size_t> counts(batch.size(), 0);
+    auto stats = ex.submit(batch, [&](std::size_t i, executor::result r)
+                                  {
+                                      std::lock_guard<std::mutex> lk(lock);
+                                      counts[i] = std::get<std::size_t>(r);
+                                  });
+
+    REQUIRE(stats.get().num_queries == batch.size());
+    for (algo::compact_graph::vert_ind_t v = 0; v < g.num_vert(); ++v)
+        REQUIRE(counts[v] == algo::count_verts_at_distance_from(g, v, 10));
+
+    auto empty = ex.submit({}, [](std::size_t, executor::result) {});
+    REQUIRE(empty.get().num_queries == 0u);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace algo
+{
+namespace test
+{
+
+// 64-bit linear congruential generator. Tests use it instead of the standard
+// engines so their graphs are the same on every platform.
+class lcg
+{
+public:
+    explicit lcg(std::uint64_t seed)
+        : state{seed}
+    {}
+
+    std::uint64_t operator()()
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state >> 33;
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// m edges with endpoints drawn uniformly from [0, n) and weights from
+// [min_weight, max_weight]; the same seed always gives the same edges.
+template <typename VertInd>
+std::vector<typename basic_graph<VertInd>::edge>
+random_edges(VertInd n, std::size_t m, std::uint64_t seed,
+             typename basic_graph<VertInd>::weight_t min_weight = 1,
+             typename basic_graph<VertInd>::weight_t max_weight = 1)
+{
+    using weight_t = typename basic_graph<VertInd>::weight_t;
+
+    lcg next(seed);
+    const auto weight_range = static_cast<std::uint64_t>(max_weight - min_weight) + 1;
+
+    std::vector<typename basic_graph<VertInd>::edge> edges(m);
+    for (auto& e : edges)
+    {
+        e.source = static_cast<VertInd>(next() % n);
+        e.target = static_cast<VertInd>(next() % n);
+        e.weight = static_cast<weight_t>(min_weight + static_cast<weight_t>(next() % weight_range));
+    }
+
+    return edges;
+}
+
+// Undirected graph on n vertices with the unit-weight edges of
+// random_edges(n, m, seed), added one at a time.
+template <typename VertInd>
+basic_graph<VertInd> random_graph(VertInd n, std::size_t m, std::uint64_t seed)
+{
+    basic_graph<VertInd> g(n);
+    for (const auto& e : random_edges(n, m, seed))
+        g.add_undirected_edge(e.source, e.target);
+
+    return g;
+}
+
+}
+}
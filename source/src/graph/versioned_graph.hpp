@@ -0,0 +1,262 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace algo
+{
+
+// Graph whose neighbour lists are stored in blocks of block_size vertices.
+// Copies share blocks and a block is copied only when it is modified while
+// shared, so a copy costs O(V / block_size) and edits touch single blocks.
+// It has the read interface of basic_graph, so the traversals declared in
+// graph.hpp run on it unchanged.
+template <typename VertInd>
+class basic_block_graph
+{
+public:
+    using vert_ind_t = VertInd;
+    using adj_list_t = typename basic_graph<VertInd>::adj_list_t;
+    using sz_t = typename basic_graph<VertInd>::sz_t;
+    using dist_t = typename basic_graph<VertInd>::dist_t;
+    using weight_t = typename basic_graph<VertInd>::weight_t;
+    using weight_list_t = typename basic_graph<VertInd>::weight_list_t;
+    using path = typename basic_graph<VertInd>::path;
+
+    constexpr static vert_ind_t npos = basic_graph<VertInd>::npos;
+    constexpr static dist_t max_dist = basic_graph<VertInd>::max_dist;
+
+    constexpr static std::size_t block_size = 64;
+
+    explicit basic_block_graph(const basic_graph<VertInd>& g)
+        : vertex_count{g.num_vert()}, undirected{g.is_undirected()}, sorted{g.has_sorted_neighbours()},
+          weighted{g.is_weighted()}
+    {
+        blocks.reserve((vertex_count + block_size - 1) / block_size);
+        for (std::size_t first = 0; first < vertex_count; first += block_size)
+        {
+            auto b = std::make_shared<adjacency_block>();
+            for (auto v = first; v < std::min(vertex_count, first + block_size); ++v)
+            {
+                b->adj.push_back(g.neighbours_of(static_cast<vert_ind_t>(v)));
+                if (weighted)
+                    b->weights.push_back(g.weights_of(static_cast<vert_ind_t>(v)));
+            }
+            blocks.push_back(std::move(b));
+        }
+    }
+
+    vert_ind_t num_vert() const
+    {
+        return static_cast<vert_ind_t>(vertex_count);
+    }
+
+    void add_undirected_edge(vert_ind_t a, vert_ind_t b, weight_t w = 1)
+    {
+        boost::contract::check c = boost::contract::function()
+            .precondition([&]{ BOOST_CONTRACT_ASSERT(w >= 0); });
+
+        append(a, b, w);
+        append(b, a, w);
+    }
+
+    void add_directed_edge(vert_ind_t source, vert_ind_t target, weight_t w = 1)
+    {
+        boost::contract::check c = boost::contract::function()
+            .precondition([&]{ BOOST_CONTRACT_ASSERT(w >= 0); });
+
+        undirected = false;
+        append(source, target, w);
+    }
+
+    const adj_list_t& neighbours_of(vert_ind_t source) const
+    {
+        return blocks.at(source / block_size)->adj[source % block_size];
+    }
+
+    // As in basic_graph, weights are stored only once an edge with a weight
+    // other than 1 is added.
+    bool is_weighted() const
+    {
+        return weighted;
+    }
+
+    // weights_of(v)[i] is the weight of the edge to neighbours_of(v)[i];
+    // only for weighted graphs.
+    const weight_list_t& weights_of(vert_ind_t source) const
+    {
+        return blocks.at(source / block_size)->weights.at(source % block_size);
+    }
+
+    bool is_undirected() const
+    {
+        return undirected;
+    }
+
+    // True while every neighbour list is in ascending order.
+    bool has_sorted_neighbours() const
+    {
+        return sorted;
+    }
+
+    bool has_edge(vert_ind_t source, vert_ind_t target) const
+    {
+        const auto& l = neighbours_of(source);
+        return detail::find_in_list(l, target, sorted) != l.size();
+    }
+
+    sz_t degree_of(vert_ind_t v) const
+    {
+        return static_cast<sz_t>(list_of(v).size());
+    }
+
+    void remove_edge(vert_ind_t a, vert_ind_t b)
+    {
+        remove_edge_from_list(a, b);
+
+        if (undirected)
+        {
+            remove_edge_from_list(b, a);
+        }
+    }
+
+private:
+    struct adjacency_block
+    {
+        std::vector<adj_list_t> adj;
+        // Empty while the graph is unweighted.
+        std::vector<weight_list_t> weights;
+    };
+
+    const adj_list_t& list_of(vert_ind_t v) const
+    {
+        return blocks[v / block_size]->adj[v % block_size];
+    }
+
+    // Block b, copied first if another graph still shares it.
+    adjacency_block& writable_block(std::size_t b)
+    {
+        auto& block = blocks[b];
+        if (block.use_count() != 1)
+            block = std::make_shared<adjacency_block>(*block);
+        else
+            std::atomic_thread_fence(std::memory_order_acquire); // pairs with the release of the last other owner
+        return *block;
+    }
+
+    void append(vert_ind_t source, vert_ind_t target, weight_t w)
+    {
+        // As in basic_graph, weight lists appear with the first edge not of
+        // unit weight; every block gets them.
+        if (w != 1 and not weighted)
+        {
+            weighted = true;
+            for (std::size_t b = 0; b < blocks.size(); ++b)
+            {
+                auto& other = writable_block(b);
+                other.weights.resize(other.adj.size());
+                for (std::size_t i = 0; i < other.adj.size(); ++i)
+                    detail::assign_unit_weights(other.adj[i], other.weights[i]);
+            }
+        }
+
+        auto& block = writable_block(source / block_size);
+        auto* weights = weighted ? &block.weights[source % block_size] : nullptr;
+        if (not detail::append_to_list(block.adj[source % block_size], weights, target, w))
+            sorted = false;
+    }
+
+    void remove_edge_from_list(vert_ind_t source, vert_ind_t target)
+    {
+        // Searched before the block is made writable, so removing a missing
+        // edge does not copy a shared block.
+        const auto pos = detail::find_in_list(list_of(source), target, sorted);
+        if (pos == list_of(source).size())
+            return;
+
+        auto& block = writable_block(source / block_size);
+        detail::erase_from_list(block.adj[source % block_size],
+                                weighted ? &block.weights[source % block_size] : nullptr, pos, sorted);
+    }
+
+    std::vector<std::shared_ptr<adjacency_block>> blocks;
+    std::size_t vertex_count;
+    bool undirected;
+    bool sorted;
+    bool weighted;
+};
+
+using block_graph = basic_block_graph<std::size_t>;
+using compact_block_graph = basic_block_graph<std::uint32_t>;
+
+// Graph shared between many reading threads and a single writer. Readers take
+// an immutable snapshot and run traversals on it; the writer edits a private
+// working copy and publishes it as the next version. The versions are block
+// graphs, so publishing copies only the block pointers and each edit copies
+// only the blocks it touches. A version is freed when the last snapshot
+// referring to it is released.
+//
+// Snapshots are published with std::atomic_load/atomic_store on a shared_ptr,
+// which libstdc++ implements with a short critical section on an internal
+// mutex pool: read() can briefly wait for a concurrent publish. Traversals on
+// a snapshot take no locks.
+template <typename VertInd>
+class basic_versioned_graph
+{
+public:
+    using graph_t = basic_block_graph<VertInd>;
+
+    struct snapshot
+    {
+        std::uint64_t version;
+        graph_t graph;
+    };
+
+    using snapshot_ptr = std::shared_ptr<const snapshot>;
+
+    explicit basic_versioned_graph(const basic_graph<VertInd>& initial)
+        : working{initial},
+          current{std::make_shared<const snapshot>(snapshot{0, working})}
+    {}
+
+    // Latest published version; safe to call from any thread.
+    snapshot_ptr read() const
+    {
+        return std::atomic_load(&current);
+    }
+
+    // Applies f to a copy of the working graph and publishes the result as a
+    // new version, whose number is returned. Writers are serialised. If f or
+    // the publish throws, neither the working graph nor the version changes.
+    template <typename F>
+    std::uint64_t update(F f)
+    {
+        std::lock_guard<std::mutex> lock(writer);
+
+        graph_t next = working;
+        f(next);
+        auto published = std::make_shared<const snapshot>(snapshot{latest_version + 1, next});
+
+        working = std::move(next);
+        ++latest_version;
+        std::atomic_store(&current, std::move(published));
+
+        return latest_version;
+    }
+
+private:
+    std::mutex writer;
+    graph_t working;
+    std::uint64_t latest_version = 0;
+    snapshot_ptr current;
+};
+
+using versioned_graph = basic_versioned_graph<std::size_t>;
+using compact_versioned_graph = basic_versioned_graph<std::uint32_t>;
+
+}
@@ -0,0 +1,130 @@
+#include "versioned_graph.hpp"
+#include "catch.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("snapshots are not affected by later updates")
+{
+    algo::versioned_graph vg(algo::graph(3));
+
+    auto before = vg.read();
+    REQUIRE(before->version == 0u);
+
+    const auto version = vg.update([](algo::block_graph& g) { g.add_undirected_edge(0, 1); });
+    auto after = vg.read();
+
+    REQUIRE(version == 1u);
+    REQUIRE(after->version == 1u);
+    REQUIRE(before->graph.neighbours_of(0).empty());
+    REQUIRE(after->graph.neighbours_of(0) == algo::graph::adj_list_t{1});
+    REQUIRE(algo::distances_from(after->graph, 0)[1] == 1);
+}
+
+TEST_CASE("a throwing update publishes nothing and leaves no partial edits")
+{
+    algo::versioned_graph vg(algo::graph(3));
+
+    REQUIRE_THROWS_AS(vg.update([](algo::block_graph& g)
+                                {
+                                    g.add_undirected_edge(0, 1);
+                                    throw std::runtime_error("edit failed");
+                                }),
+                      std::runtime_error);
+    REQUIRE(vg.read()->version == 0u);
+
+    const auto version = vg.update([](algo::block_graph& g) { g.add_undirected_edge(1, 2); });
+    auto snap = vg.read();
+
+    REQUIRE(version == 1u);
+    REQUIRE(snap->version == 1u);
+    REQUIRE(snap->graph.neighbours_of(0).empty());
+    REQUIRE(snap->graph.neighbours_of(1) == algo::graph::adj_list_t{2});
+}
+
+TEST_CASE("block graph copies are independent across blocks")
+{
+    const algo::graph::vert_ind_t n = 3 * algo::block_graph::block_size + 5;
+    algo::graph path(n);
+    for (algo::graph::vert_ind_t v = 1; v < n; ++v)
+        path.add_undirected_edge(v - 1, v);
+
+    const algo::block_graph g(path);
+    auto copy = g;
+    copy.remove_edge(10, 11);
+    copy.add_directed_edge(n - 1, 0);
+
+    REQUIRE(algo::distances_from(g, 0) == algo::distances_from(path, 0));
+    REQUIRE(g.neighbours_of(n - 1) == algo::graph::adj_list_t{n - 2});
+
+    REQUIRE(not copy.is_undirected());
+    REQUIRE(copy.neighbours_of(10) == algo::graph::adj_list_t{9});
+    REQUIRE(copy.neighbours_of(n - 1) == (algo::graph::adj_list_t{n - 2, 0}));
+    REQUIRE(algo::distances_from(copy, 11)[10] == static_cast<algo::graph::dist_t>(n - 1));
+}
+
+TEST_CASE("block graph edits keep lists and weights as basic_graph does")
+{
+    const algo::graph::vert_ind_t n = 2 * algo::block_graph::block_size;
+    algo::graph g(n);
+    algo::block_graph bg(g);
+
+    auto edit = [](auto& h)
+                {
+                    h.add_directed_edge(5, 100);
+                    h.add_directed_edge(5, 3);
+                    h.add_directed_edge(70, 5, 4);
+                    h.add_directed_edge(5, 90, 2);
+                    h.remove_edge(5, 3);
+                    h.remove_edge(5, 42);
+                };
+    edit(g);
+    edit(bg);
+
+    REQUIRE(bg.is_weighted() == g.is_weighted());
+    REQUIRE(bg.has_sorted_neighbours() == g.has_sorted_neighbours());
+    for (algo::graph::vert_ind_t v = 0; v < n; ++v)
+    {
+        REQUIRE(bg.neighbours_of(v) == g.neighbours_of(v));
+        REQUIRE(bg.weights_of(v) == g.weights_of(v));
+    }
+    REQUIRE(bg.has_edge(5, 90));
+    REQUIRE(not bg.has_edge(5, 3));
+}
+
+TEST_CASE("readers traverse consistent snapshots while the writer publishes")
+{
+    const algo::graph::vert_ind_t n = 500;
+    algo::versioned_graph vg{algo::graph(n)};
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+
+    // Version k holds the path 0 - 1 - ... - k, so vertex k is at distance k
+    // and vertex k + 1 is unreachable.
+    auto reader = [&]
+                  {
+                      while (not done)
+                      {
+                          auto snap = vg.read();
+                          const auto k = static_cast<algo::graph::vert_ind_t>(snap->version);
+                          const auto dists = algo::distances_from(snap->graph, 0);
+                          if (dists[k] != static_cast<algo::graph::dist_t>(k)
+                              or (k + 1 < n and dists[k + 1] != algo::graph::max_dist))
+                              ++inconsistent;
+                      }
+                  };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) readers.emplace_back(reader);
+
+    for (algo::graph::vert_ind_t v = 1; v < n; ++v)
+        vg.update([v](algo::block_graph& g) { g.add_undirected_edge(v - 1, v); });
+
+    done = true;
+    for (auto& r : readers) r.join();
+
+    REQUIRE(inconsistent == 0);
+    REQUIRE(vg.read()->version == n - 1);
+}